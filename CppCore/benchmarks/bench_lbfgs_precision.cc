@@ -0,0 +1,102 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+// Iterations and time against history memory for the L-BFGS storage
+// precisions, on a trial function and a large extended Rosenbrock.
+#include <fmt/format.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "xtensor/xbuilder.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linesearch/conditions/armijo.hpp"
+#include "xtsci/optimize/linesearch/search_strategy/backtracking.hpp"
+#include "xtsci/optimize/minimize/lbfgs.hpp"
+
+namespace {
+using xts::optimize::FuncVec;
+using xts::optimize::ScalarType;
+using xts::optimize::ScalarVec;
+using xts::optimize::minimize::HistoryPrecision;
+
+// sum_i 100 (x_{2i+1} - x_{2i}^2)^2 + (1 - x_{2i})^2
+class ExtendedRosenbrock : public xts::optimize::eval::FusedObjective {
+protected:
+  xts::optimize::eval::ValueGradient
+  compute_value_and_gradient(const FuncVec &x) const override {
+    ScalarType value = 0.0;
+    FuncVec gradient = xt::zeros<ScalarType>(x.shape());
+    for (size_t idx = 0; idx + 1 < x.size(); idx += 2) {
+      const ScalarType lead = x(idx), next = x(idx + 1);
+      const ScalarType valley = next - lead * lead;
+      value += 100.0 * valley * valley + (1.0 - lead) * (1.0 - lead);
+      gradient(idx) = -400.0 * lead * valley - 2.0 * (1.0 - lead);
+      gradient(idx + 1) = 200.0 * valley;
+    }
+    return {value, std::move(gradient)};
+  }
+};
+
+const char *name(HistoryPrecision precision) {
+  switch (precision) {
+  case HistoryPrecision::Double:
+    return "double";
+  case HistoryPrecision::Single:
+    return "float";
+  case HistoryPrecision::BFloat16:
+    return "bfloat16";
+  }
+  return "";
+}
+
+// Each run on a fresh objective, whose counts are its own
+template <typename Objective>
+void run(const std::string &label, const ScalarVec &start, size_t mem) {
+  for (auto precision : {HistoryPrecision::Double, HistoryPrecision::Single,
+                         HistoryPrecision::BFloat16}) {
+    Objective func;
+    xts::optimize::OptimizeControl control;
+    control.max_iterations = 20000;
+    xts::optimize::linesearch::conditions::ArmijoCondition armijo;
+    xts::optimize::linesearch::search_strategy::BacktrackingSearch search(
+        armijo, 0.5, control);
+    xts::optimize::minimize::LBFGSOptimizer optimizer(
+        search, mem, xts::optimize::minimize::LBFGSEngine::TwoLoop,
+        precision);
+    auto begin = std::chrono::steady_clock::now();
+    ScalarVec origin = xt::zeros<ScalarType>(start.shape());
+    auto result = optimizer.optimize(func, {start, origin});
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - begin;
+    fmt::print("{:>20} {:>4} {:>9} {:>7} {:>7} {:>12} {:>10.3f} {:>12.4e}\n",
+               label, mem, name(precision), result.nit, result.nufg,
+               optimizer.history_bytes(), elapsed.count(), result.fun);
+  }
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const size_t ndim = argc > 1 ? std::stoul(argv[1]) : 100000;
+  fmt::print("{:>20} {:>4} {:>9} {:>7} {:>7} {:>12} {:>10} {:>12}\n",
+             "Function", "m", "History", "nit", "nufg", "Bytes", "Time (s)",
+             "f(x)");
+
+  for (size_t mem : {5, 10, 20}) {
+    run<xts::func::trial::D2::Rosenbrock<ScalarType>>(
+        "Rosenbrock 2D", ScalarVec{-1.2, 1.0}, mem);
+  }
+
+  ScalarVec start = xt::empty<ScalarType>({ndim});
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    start(idx) = idx % 2 == 0 ? -1.2 : 1.0;
+  }
+  for (size_t mem : {5, 10, 20}) {
+    run<ExtendedRosenbrock>(fmt::format("Rosenbrock {}D", ndim), start, mem);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,97 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <filesystem>
+#include <string>
+
+#include "xtensor/xtensor.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/eval/adaptor.hpp"
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linesearch/search_strategy/zoom.hpp"
+#include "xtsci/optimize/linesearch/step_size/hermite.hpp"
+#include "xtsci/optimize/minimize/lbfgs.hpp"
+#include "xtsci/optimize/minimize/pso.hpp"
+
+#include <catch2/catch_all.hpp>
+
+namespace {
+using xts::optimize::OptimizeControl;
+using xts::optimize::ScalarVec;
+using xts::optimize::SearchState;
+
+std::string checkpoint_path(const std::string &name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+} // namespace
+
+TEST_CASE("L-BFGS resumes exactly from a checkpoint", "[Checkpoint]") {
+  xts::optimize::linesearch::step_size::HermiteInterpolationStepSize hermite;
+  const std::string path = checkpoint_path("xtsci_lbfgs_resume.npz");
+  const SearchState start(ScalarVec{-1.2, 1.0}, ScalarVec{0.0, 0.0});
+
+  // Uninterrupted
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom(hermite);
+  xts::optimize::minimize::LBFGSOptimizer lbfgs(zoom, 6);
+  auto reference = lbfgs.optimize(rosen, start);
+  REQUIRE(reference.nit > 10);
+
+  // Stopped after 10 iterations, with a checkpoint there
+  OptimizeControl stop(10, 1e-6, false);
+  stop.checkpoint_interval = 10;
+  stop.checkpoint_path = path;
+  xts::func::trial::D2::Rosenbrock<double> first;
+  xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom_stop(
+      hermite, 1e-4, 0.9, stop);
+  xts::optimize::minimize::LBFGSOptimizer interrupted(zoom_stop, 6);
+  auto before = interrupted.optimize(first, start);
+  REQUIRE(before.nit == 10);
+
+  // Finished by a new optimizer on a new objective
+  xts::func::trial::D2::Rosenbrock<double> second;
+  xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom_resume(
+      hermite);
+  xts::optimize::minimize::LBFGSOptimizer resumed(zoom_resume, 6);
+  auto after = resumed.resume(second, path);
+  std::filesystem::remove(path);
+
+  REQUIRE(after.nit == reference.nit);
+  REQUIRE(after.x == reference.x);
+  REQUIRE(after.fun == reference.fun);
+  // Both parts end with the evaluation of get_result, which the uninterrupted
+  // run makes once
+  xts::func::trial::D2::Rosenbrock<double> final_point;
+  xts::optimize::eval::value_and_gradient(final_point, before.x);
+  auto extra = xts::optimize::eval::tally(final_point);
+  REQUIRE(before.nfev + after.nfev == reference.nfev + extra.nfev);
+  REQUIRE(before.njev + after.njev == reference.njev + extra.njev);
+}
+
+TEST_CASE("PSO resumes exactly from a checkpoint", "[Checkpoint]") {
+  // The generator is seeded at random, the checkpoint carries its state, so
+  // the run which wrote it is the uninterrupted one
+  const size_t particles = 10;
+  const std::string path = checkpoint_path("xtsci_pso_resume.npz");
+  const ScalarVec lower = {-2.0, -2.0};
+  const ScalarVec upper = {2.0, 2.0};
+  OptimizeControl control(15, 1e-6, false);
+  control.checkpoint_interval = 10;
+  control.checkpoint_path = path;
+
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::minimize::PSOptim swarm(particles, 0.5, 1.5, 1.5, control);
+  auto reference = swarm.optimize(rosen, lower, upper);
+  REQUIRE(reference.nit == 15);
+
+  xts::func::trial::D2::Rosenbrock<double> other;
+  xts::optimize::minimize::PSOptim resumed(particles, 0.5, 1.5, 1.5, control);
+  auto after = resumed.resume(other, lower, upper, path);
+  std::filesystem::remove(path);
+
+  REQUIRE(after.nit == reference.nit);
+  REQUIRE(after.x == reference.x);
+  REQUIRE(after.fun == reference.fun);
+  // The initial swarm and the first 10 updates are not repeated
+  REQUIRE(after.nfev + particles * 11 == reference.nfev);
+}
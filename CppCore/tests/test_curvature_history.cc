@@ -0,0 +1,229 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "xtensor/xtensor.hpp"
+
+#include "xtsci/optimize/qn/compact_lbfgs.hpp"
+#include "xtsci/optimize/qn/bfloat16.hpp"
+#include "xtsci/optimize/qn/compact_sr1.hpp"
+#include "xtsci/optimize/qn/curvature_history.hpp"
+#include "xtsci/optimize/qn/warm_start.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+TEST_CASE("CurvatureHistory ring buffer", "[QuasiNewton]") {
+  using xts::optimize::ScalarVec;
+  // y = A s for A = diag(1, 2, 4)
+  xts::optimize::qn::CurvatureHistory history(2, 3);
+  ScalarVec s1 = {1.0, 0.0, 0.0}, y1 = {1.0, 0.0, 0.0};
+  ScalarVec s2 = {0.0, 1.0, 0.0}, y2 = {0.0, 2.0, 0.0};
+  ScalarVec s3 = {0.0, 0.0, 1.0}, y3 = {0.0, 0.0, 4.0};
+
+  SECTION("The newest pair satisfies the secant condition") {
+    REQUIRE(history.push(s1, y1));
+    REQUIRE(history.push(s2, y2));
+    ScalarVec q = y2;
+    history.apply_inverse(q);
+    REQUIRE_THAT(q(1), Catch::Matchers::WithinAbs(1.0, 1e-14));
+  }
+
+  SECTION("The oldest pair is overwritten once full") {
+    history.push(s1, y1);
+    history.push(s2, y2);
+    history.push(s3, y3);
+    REQUIRE(history.size() == 2);
+    REQUIRE(history.s(0)(1) == 1.0);
+    REQUIRE(history.s(1)(2) == 1.0);
+    REQUIRE_THAT(history.gamma(), Catch::Matchers::WithinAbs(0.25, 1e-14));
+  }
+
+  SECTION("Rows outside the ring are zero") {
+    history.push(s1, y1);
+    history.push(s2, y2);
+    history.push(s3, y3);
+    const size_t spare = history.slot(history.size());
+    const auto &pairs = history.pairs();
+    for (size_t idx = 0; idx < 3; ++idx) {
+      REQUIRE(pairs(spare, idx) == 0.0);
+      REQUIRE(pairs(history.rows() + spare, idx) == 0.0);
+    }
+  }
+
+  SECTION("Pairs without positive curvature are rejected") {
+    history.push(s1, y1);
+    history.push(s2, y2);
+    ScalarVec bad = -s3;
+    REQUIRE_FALSE(history.push(bad, y3));
+    REQUIRE(history.size() == 2);
+    REQUIRE(history.s(0)(0) == 1.0);
+  }
+}
+
+TEST_CASE("BFloat16 rounds to nearest even", "[QuasiNewton]") {
+  using xts::optimize::qn::BFloat16;
+  auto from_bits = [](uint32_t word) { return std::bit_cast<float>(word); };
+  // One unit in the last place of bfloat16 at 1 is 2^-7
+  REQUIRE(BFloat16(1.0f).bits == 0x3F80);
+  REQUIRE(BFloat16(from_bits(0x3F808000)).bits == 0x3F80); // tie, stays even
+  REQUIRE(BFloat16(from_bits(0x3F818000)).bits == 0x3F82); // tie, up to even
+  REQUIRE(BFloat16(from_bits(0x3F808001)).bits == 0x3F81); // above the tie
+  REQUIRE(BFloat16(from_bits(0x3F807FFF)).bits == 0x3F80); // below the tie
+  REQUIRE(BFloat16(-2.0).bits == 0xC000);
+  REQUIRE(static_cast<double>(BFloat16(0.1)) == 0.10009765625);
+
+  SECTION("Infinities and overflow") {
+    const float inf = std::numeric_limits<float>::infinity();
+    REQUIRE(BFloat16(inf).bits == 0x7F80);
+    REQUIRE(BFloat16(-inf).bits == 0xFF80);
+    REQUIRE(std::isinf(static_cast<float>(
+        BFloat16(std::numeric_limits<float>::max()))));
+  }
+
+  SECTION("NaN stays NaN") {
+    REQUIRE(std::isnan(static_cast<float>(
+        BFloat16(std::numeric_limits<float>::quiet_NaN()))));
+    // The payload is in the bits rounding drops, it must not become an
+    // infinity
+    REQUIRE(std::isnan(static_cast<float>(BFloat16(from_bits(0x7F800001)))));
+    REQUIRE(std::isnan(static_cast<float>(BFloat16(from_bits(0xFF800001)))));
+  }
+}
+
+TEST_CASE("Compact representation matches the two-loop recursion",
+          "[QuasiNewton]") {
+  using xts::optimize::ScalarMatrix;
+  using xts::optimize::ScalarVec;
+  xts::optimize::qn::CurvatureHistory history(2, 3);
+  xts::optimize::qn::CompactLBFGS compact(2, 3);
+  // y = A s for A = [[4, 1, 0], [1, 3, 1], [0, 1, 2]]
+  ScalarMatrix steps = {{1.0, 0.5, 0.0}, {0.0, 1.0, -1.0}, {0.3, 0.0, 1.0}};
+  for (size_t idx = 0; idx < 3; ++idx) {
+    ScalarVec s = xt::row(steps, idx);
+    ScalarVec y = {4 * s(0) + s(1), s(0) + 3 * s(1) + s(2), s(1) + 2 * s(2)};
+    history.push(s, y);
+    compact.push(s, y);
+  }
+  REQUIRE(compact.size() == 2);
+
+  ScalarVec expected = {0.7, -1.1, 0.4};
+  ScalarVec actual = expected;
+  history.apply_inverse(expected);
+  compact.apply_inverse(actual);
+  for (size_t idx = 0; idx < 3; ++idx) {
+    REQUIRE_THAT(actual(idx), Catch::Matchers::WithinAbs(expected(idx), 1e-12));
+  }
+
+  SECTION("Several vectors at once") {
+    ScalarMatrix vectors = {{0.7, -1.1, 0.4}, {0.7, -1.1, 0.4}};
+    compact.apply_inverse(vectors);
+    REQUIRE_THAT(vectors(1, 2), Catch::Matchers::WithinAbs(expected(2), 1e-12));
+  }
+}
+
+TEST_CASE("Warm start pairs round trip", "[QuasiNewton]") {
+  using xts::optimize::ScalarVec;
+  xts::optimize::qn::CurvatureHistory history(3, 3);
+  ScalarVec s1 = {1.0, 0.0, 0.0}, y1 = {1.0, 0.0, 0.0};
+  ScalarVec s2 = {0.0, 1.0, 0.0}, y2 = {0.0, 2.0, 0.0};
+  history.push(s1, y1);
+  history.push(s2, y2);
+  auto pairs = xts::optimize::qn::export_pairs(history);
+  REQUIRE(pairs.size() == 2);
+  REQUIRE(pairs.y(1, 1) == 2.0);
+
+  SECTION("Seeded pairs give the same inverse Hessian") {
+    xts::optimize::qn::FloatCurvatureHistory seeded(3, 3);
+    REQUIRE(xts::optimize::qn::seed(seeded, pairs) == 2);
+    ScalarVec q = y2;
+    seeded.apply_inverse(q);
+    REQUIRE_THAT(q(1), Catch::Matchers::WithinAbs(1.0, 1e-6));
+  }
+
+  SECTION("Nearly orthogonal pairs are dropped") {
+    pairs.y(0, 0) = 1e-12;
+    pairs.y(0, 1) = 1.0;
+    xts::optimize::qn::CurvatureHistory seeded(3, 3);
+    REQUIRE(xts::optimize::qn::seed(seeded, pairs) == 1);
+    REQUIRE(seeded.s(0)(1) == 1.0);
+  }
+
+  SECTION("Pairs must match the problem size") {
+    xts::optimize::qn::CurvatureHistory seeded(3, 4);
+    REQUIRE_THROWS(xts::optimize::qn::seed(seeded, pairs));
+  }
+}
+
+TEST_CASE("Compact SR1 keeps indefinite curvature", "[QuasiNewton]") {
+  using xts::optimize::ScalarVec;
+  // y = A s for A = diag(1, -2, 4), the first pair has s.y < 0
+  xts::optimize::qn::CompactSR1 sr1(3, 3);
+  ScalarVec s1 = {1.0, 1.0, 0.0}, y1 = {1.0, -2.0, 0.0};
+  ScalarVec s2 = {0.0, 1.0, 1.0}, y2 = {0.0, -2.0, 4.0};
+  REQUIRE(sr1.push(s1, y1));
+  REQUIRE(sr1.push(s2, y2));
+
+  SECTION("Secant conditions hold for every pair on a quadratic") {
+    ScalarVec v1 = s1, v2 = s2;
+    REQUIRE(sr1.apply(v1));
+    REQUIRE(sr1.apply(v2));
+    for (size_t idx = 0; idx < 3; ++idx) {
+      REQUIRE_THAT(v1(idx), Catch::Matchers::WithinAbs(y1(idx), 1e-12));
+      REQUIRE_THAT(v2(idx), Catch::Matchers::WithinAbs(y2(idx), 1e-12));
+    }
+  }
+
+  SECTION("H inverts B") {
+    ScalarVec v = y2;
+    REQUIRE(sr1.apply_inverse(v));
+    for (size_t idx = 0; idx < 3; ++idx) {
+      REQUIRE_THAT(v(idx), Catch::Matchers::WithinAbs(s2(idx), 1e-12));
+    }
+  }
+
+  SECTION("Pairs B already satisfies are skipped") {
+    ScalarVec known = y1;
+    REQUIRE_FALSE(sr1.push(s1, known));
+    REQUIRE(sr1.size() == 2);
+  }
+}
+
+TEST_CASE("Compact SR1 recovers from a singular middle matrix",
+          "[QuasiNewton]") {
+  using xts::optimize::ScalarMatrix;
+  using xts::optimize::ScalarVec;
+  xts::optimize::qn::CompactSR1 sr1(3, 2);
+
+  SECTION("delta comes from the pair which starts the history") {
+    REQUIRE(sr1.push(ScalarVec{1.0, 0.0}, ScalarVec{-1.0, 0.0}));
+    REQUIRE(sr1.delta() == 1.0);
+    REQUIRE(sr1.push(ScalarVec{0.0, 1.0}, ScalarVec{0.0, 3.0}));
+    REQUIRE(sr1.delta() == 1.0);
+    sr1.clear();
+    REQUIRE(sr1.push(ScalarVec{1.0, 1.0}, ScalarVec{2.0, 3.0}));
+    REQUIRE_THAT(sr1.delta(), Catch::Matchers::WithinAbs(13.0 / 5.0, 1e-15));
+  }
+
+  SECTION("The oldest pairs are dropped") {
+    // A repeated pair makes every entry of M the same
+    ScalarMatrix s = {{1.0, 0.0}, {1.0, 0.0}};
+    ScalarMatrix y = {{2.0, 0.0}, {2.0, 0.0}};
+    sr1.restore(s, y, 1.0);
+    ScalarVec v = {1.0, 1.0};
+    REQUIRE_FALSE(sr1.apply(v));
+
+    // Against B = diag(2, 1) from the newer copy alone
+    REQUIRE(sr1.push(ScalarVec{0.0, 1.0}, ScalarVec{0.0, 3.0}));
+    REQUIRE(sr1.size() == 2);
+    REQUIRE(sr1.s(0)(0) == 1.0);
+    REQUIRE(sr1.s(1)(1) == 1.0);
+    v = {1.0, 1.0};
+    REQUIRE(sr1.apply(v));
+    REQUIRE_THAT(v(0), Catch::Matchers::WithinAbs(2.0, 1e-12));
+    REQUIRE_THAT(v(1), Catch::Matchers::WithinAbs(3.0, 1e-12));
+  }
+}
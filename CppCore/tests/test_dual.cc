@@ -0,0 +1,85 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cmath>
+
+#include "xtensor/xarray.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/autodiff/directional.hpp"
+#include "xtsci/optimize/autodiff/dual.hpp"
+#include "xtsci/optimize/base.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+namespace {
+template <typename T> T rosenbrock(const T &x, const T &y) {
+  using std::pow;
+  return pow(1.0 - x, 2.0) + 100.0 * pow(y - x * x, 2.0);
+}
+} // namespace
+
+TEST_CASE("Dual numbers carry directional derivatives", "[Autodiff]") {
+  using Dual = xts::optimize::autodiff::Dual<double>;
+
+  SECTION("Elementary functions") {
+    Dual x{0.5, 1.0};
+    REQUIRE_THAT(sin(x).eps, Catch::Matchers::WithinAbs(std::cos(0.5), 1e-15));
+    REQUIRE_THAT(exp(x).eps, Catch::Matchers::WithinAbs(std::exp(0.5), 1e-15));
+    REQUIRE_THAT(log(x).eps, Catch::Matchers::WithinAbs(2.0, 1e-15));
+    REQUIRE_THAT(sqrt(x).eps,
+                 Catch::Matchers::WithinAbs(1.0 / (2 * std::sqrt(0.5)), 1e-15));
+    REQUIRE_THAT((x / (1.0 + x)).eps,
+                 Catch::Matchers::WithinAbs(1 / 2.25, 1e-15));
+  }
+
+  SECTION("Constant exponents of a negative base") {
+    Dual x{-2.0, 1.0};
+    Dual cube = pow(x, Dual{3.0});
+    REQUIRE(cube.val == -8.0);
+    REQUIRE_THAT(cube.eps, Catch::Matchers::WithinAbs(12.0, 1e-12));
+    REQUIRE(pow(x, 2.0).eps == -4.0);
+  }
+
+  SECTION("A single pass gives phi and phi'") {
+    // grad f(-1.2, 1) = (-215.6, -88)
+    Dual x{-1.2, 1.0}, y{1.0, 0.5};
+    Dual phi = rosenbrock(x, y);
+    REQUIRE_THAT(phi.val, Catch::Matchers::WithinAbs(24.2, 1e-12));
+    REQUIRE_THAT(phi.eps,
+                 Catch::Matchers::WithinAbs(-215.6 - 0.5 * 88.0, 1e-10));
+  }
+}
+
+TEST_CASE("Line probes take phi' from the dual pass", "[Autodiff]") {
+  using xts::optimize::FuncVec;
+  using xts::optimize::ScalarVec;
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::autodiff::DualDirectional<xts::func::trial::D2::Rosenbrock>
+      directional(rosen);
+  xts::optimize::SearchState line(ScalarVec{-1.2, 1.0}, ScalarVec{1.0, 0.5});
+  const double alpha = 0.1;
+  FuncVec trial = {-1.1, 1.05};
+  auto gradient = rosen.gradient(trial).value();
+  const double slope = gradient(0) + 0.5 * gradient(1);
+
+  SECTION("Trials evaluated with their slopes") {
+    xts::optimize::LineProbe probe(directional, line, true);
+    const auto &point = probe.at(alpha);
+    REQUIRE_THAT(point.phi, Catch::Matchers::WithinAbs(rosen(trial), 1e-12));
+    REQUIRE_THAT(point.phi_prime, Catch::Matchers::WithinRel(slope, 1e-12));
+    REQUIRE_FALSE(point.has_gradient());
+    auto counts = xts::optimize::eval::tally(directional);
+    REQUIRE(counts.ndev == 1);
+    REQUIRE(counts.njev == 1); // the reference gradient above
+  }
+
+  SECTION("A slope added to a value") {
+    xts::optimize::LineProbe probe(directional, line);
+    probe.phi(alpha);
+    REQUIRE(xts::optimize::eval::tally(directional).ndev == 0);
+    REQUIRE_THAT(probe.phi_prime(alpha),
+                 Catch::Matchers::WithinRel(slope, 1e-12));
+    REQUIRE(xts::optimize::eval::tally(directional).ndev == 1);
+  }
+}
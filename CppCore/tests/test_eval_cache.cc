@@ -0,0 +1,106 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <utility>
+
+#include "xtensor/xarray.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/eval/cache.hpp"
+#include "xtsci/optimize/eval/fused.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+namespace {
+// f = x.x / 2, value and gradient from one call
+class Quadratic : public xts::optimize::eval::FusedObjective {
+protected:
+  xts::optimize::eval::ValueGradient
+  compute_value_and_gradient(const xt::xarray<double> &x) const override {
+    xt::xarray<double> gradient = x;
+    return {0.5 * (x(0) * x(0) + x(1) * x(1)), std::move(gradient)};
+  }
+};
+} // namespace
+
+TEST_CASE("CachedObjective serves repeated requests", "[Evaluation]") {
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::eval::CachedObjective cached(rosen, 2);
+
+  xt::xarray<double> point_a = {0.0, 0.0};
+  xt::xarray<double> point_b = {1.0, 1.0};
+  xt::xarray<double> point_c = {-1.2, 1.0};
+
+  SECTION("Values and gradients are memoized separately") {
+    REQUIRE_THAT(cached(point_a), Catch::Matchers::WithinAbs(1.0, 1e-12));
+    REQUIRE_THAT(cached(point_a), Catch::Matchers::WithinAbs(1.0, 1e-12));
+    auto grad = cached.gradient(point_a).value();
+    REQUIRE_THAT(grad(0), Catch::Matchers::WithinAbs(-2.0, 1e-12));
+    cached.gradient(point_a);
+
+    auto counts = xts::optimize::eval::tally(cached);
+    REQUIRE(counts.nfev == 1);
+    REQUIRE(counts.njev == 1);
+    REQUIRE(counts.nfev_cached == 1);
+    REQUIRE(counts.njev_cached == 1);
+  }
+
+  SECTION("Least recently used entries are evicted") {
+    cached(point_a);
+    cached(point_b);
+    cached(point_a); // a is now the most recent
+    cached(point_c); // evicts b
+    cached(point_a);
+    cached(point_b);
+
+    auto counts = xts::optimize::eval::tally(cached);
+    REQUIRE(counts.nfev == 4);
+    REQUIRE(counts.nfev_cached == 2);
+  }
+
+  SECTION("Repeated rows of a batch are evaluated once") {
+    cached(point_a);
+    xts::optimize::ScalarMatrix rows = {
+        {0.0, 0.0}, {1.0, 1.0}, {1.0, 1.0}, {-1.2, 1.0}, {1.0, 1.0}};
+    auto batch = cached.evaluate_batch(rows, false);
+    REQUIRE_THAT(batch.values(2), Catch::Matchers::WithinAbs(0.0, 1e-12));
+    REQUIRE(batch.values(1) == batch.values(4));
+    REQUIRE_THAT(batch.values(3), Catch::Matchers::WithinAbs(24.2, 1e-12));
+
+    auto counts = xts::optimize::eval::tally(cached);
+    REQUIRE(counts.nfev == 3);
+    REQUIRE(counts.nfev_cached == 3);
+  }
+
+  SECTION("Keys are exact coordinates") {
+    xt::xarray<double> nearby = {1e-300, 0.0};
+    cached(point_a);
+    cached(nearby);
+    REQUIRE(xts::optimize::eval::tally(cached).nfev == 2);
+  }
+}
+
+TEST_CASE("CachedObjective keeps the gradient of a fused value",
+          "[Evaluation]") {
+  Quadratic quadratic;
+  xts::optimize::eval::CachedObjective cached(quadratic);
+  xt::xarray<double> point = {1.0, 2.0};
+
+  SECTION("A value miss") {
+    REQUIRE(cached(point) == 2.5);
+    auto grad = cached.gradient(point).value();
+    REQUIRE(grad(1) == 2.0);
+  }
+
+  SECTION("A batch of values") {
+    xts::optimize::ScalarMatrix rows = {{1.0, 2.0}};
+    cached.evaluate_batch(rows, false);
+    cached.gradient(point);
+  }
+
+  REQUIRE(quadratic.fused_evaluations() == 1);
+  auto counts = xts::optimize::eval::tally(cached);
+  REQUIRE(counts.nfev == 1);
+  REQUIRE(counts.njev == 1);
+  REQUIRE(counts.njev_cached == 1);
+}
@@ -0,0 +1,71 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstring>
+#include <vector>
+
+#include "xtensor/xarray.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/eval/ledger.hpp"
+
+#include <catch2/catch_all.hpp>
+
+namespace {
+xts::optimize::eval::CallSiteSummary
+site_named(const std::vector<xts::optimize::eval::CallSiteSummary> &sites,
+           const char *tag) {
+  for (const auto &site : sites) {
+    if (std::strcmp(site.tag, tag) == 0) {
+      return site;
+    }
+  }
+  FAIL("No calls from " << tag);
+  return {};
+}
+} // namespace
+
+TEST_CASE("EvaluationLedger finds duplicate requests", "[Evaluation]") {
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::eval::EvaluationLedger ledger(rosen, 8);
+  xt::xarray<double> point = {-1.2, 1.0};
+
+  SECTION("The same point asked for twice") {
+    {
+      xts::optimize::eval::ScopedCallSite site("first");
+      ledger(point);
+      ledger.gradient(point); // a new quantity, not a duplicate
+    }
+    {
+      xts::optimize::eval::ScopedCallSite site("second");
+      ledger(point);
+      xts::optimize::eval::value_and_gradient(ledger, point);
+    }
+    REQUIRE(ledger.total_calls() == 4);
+    auto sites = ledger.summary();
+    REQUIRE(sites.size() == 2);
+    auto first = site_named(sites, "first");
+    REQUIRE(first.calls == 2);
+    REQUIRE(first.duplicates == 0);
+    auto second = site_named(sites, "second");
+    REQUIRE(second.calls == 2);
+    REQUIRE(second.duplicates == 2);
+  }
+
+  SECTION("Distinct points are not duplicates") {
+    ledger(point);
+    ledger(xt::xarray<double>{-1.2, 1.0 + 1e-12});
+    auto sites = ledger.summary();
+    REQUIRE(sites.size() == 1);
+    REQUIRE(sites[0].calls == 2);
+    REQUIRE(sites[0].duplicates == 0);
+  }
+
+  SECTION("Only the window is kept") {
+    for (size_t idx = 0; idx < 10; ++idx) {
+      ledger(point);
+    }
+    REQUIRE(ledger.total_calls() == 10);
+    REQUIRE(ledger.records().size() == 8);
+    REQUIRE(site_named(ledger.summary(), "untagged").duplicates == 7);
+  }
+}
@@ -0,0 +1,82 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <utility>
+
+#include "xtensor/xarray.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/eval/adaptor.hpp"
+#include "xtsci/optimize/eval/batch.hpp"
+#include "xtsci/optimize/eval/finite_difference.hpp"
+#include "xtsci/optimize/parallel/thread_pool.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+namespace {
+using xts::optimize::FuncVec;
+using xts::optimize::ScalarType;
+
+// Rosenbrock which may be evaluated from several threads
+class SharedRosenbrock : public xts::optimize::eval::FusedObjective,
+                         public xts::optimize::eval::ConcurrentEvaluation {
+protected:
+  xts::optimize::eval::ValueGradient
+  compute_value_and_gradient(const FuncVec &x) const override {
+    const ScalarType valley = x(1) - x(0) * x(0);
+    FuncVec gradient = {-400.0 * x(0) * valley - 2.0 * (1.0 - x(0)),
+                        200.0 * valley};
+    return {100.0 * valley * valley + (1.0 - x(0)) * (1.0 - x(0)),
+            std::move(gradient)};
+  }
+};
+} // namespace
+
+TEST_CASE("Finite difference gradients", "[Evaluation]") {
+  using xts::optimize::eval::FDScheme;
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xt::xarray<double> point = {-1.2, 1.0};
+  auto exact = rosen.gradient(point).value();
+
+  SECTION("Central differences") {
+    xts::optimize::eval::FiniteDifferenceObjective fd(rosen);
+    auto grad = fd.gradient(point).value();
+    REQUIRE_THAT(grad(0), Catch::Matchers::WithinRel(exact(0), 1e-7));
+    REQUIRE_THAT(grad(1), Catch::Matchers::WithinRel(exact(1), 1e-7));
+  }
+
+  SECTION("Forward differences with per-coordinate steps") {
+    xts::optimize::eval::FiniteDifferenceControl control;
+    control.scheme = FDScheme::Forward;
+    control.abs_step = {1e-8, 1e-7};
+    xts::optimize::eval::FiniteDifferenceObjective fd(rosen, control);
+    auto [value, grad] = fd.value_and_gradient(point);
+    REQUIRE_THAT(value, Catch::Matchers::WithinAbs(rosen(point), 1e-12));
+    REQUIRE_THAT(grad(0), Catch::Matchers::WithinRel(exact(0), 1e-5));
+    REQUIRE_THAT(grad(1), Catch::Matchers::WithinRel(exact(1), 1e-5));
+  }
+
+  SECTION("Threaded evaluation matches the serial one") {
+    xts::optimize::parallel::ThreadPool pool(4);
+    SharedRosenbrock plain, shared;
+    xts::optimize::eval::FiniteDifferenceObjective serial(plain);
+    xts::optimize::eval::FiniteDifferenceObjective threaded(shared, pool);
+    auto grad_serial = serial.gradient(point).value();
+    auto grad_threaded = threaded.gradient(point).value();
+    REQUIRE(grad_serial(0) == grad_threaded(0));
+    REQUIRE(grad_serial(1) == grad_threaded(1));
+    // Four displaced points, on the pool through the counted value_only
+    REQUIRE(shared.value_evaluations() == 4);
+    REQUIRE(shared.evaluation_counts().function_evals == 0);
+    REQUIRE(xts::optimize::eval::tally(shared).nfev == 4);
+    REQUIRE(xts::optimize::eval::tally(plain).nfev == 4);
+  }
+
+  SECTION("Plain objectives stay serial with a pool") {
+    xts::optimize::parallel::ThreadPool pool(4);
+    xts::optimize::eval::FiniteDifferenceObjective threaded(rosen, pool);
+    auto grad = threaded.gradient(point).value();
+    REQUIRE_THAT(grad(0), Catch::Matchers::WithinRel(exact(0), 1e-7));
+    REQUIRE(rosen.evaluation_counts().function_evals == 4);
+  }
+}
@@ -0,0 +1,49 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor/xarray.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/autodiff/directional.hpp"
+#include "xtsci/optimize/eval/hvp.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+TEST_CASE("Hessian-vector products by gradient differences", "[Evaluation]") {
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::eval::GradientDifferenceHVP provider(rosen);
+  xt::xarray<double> point = {-1.2, 1.0};
+  xt::xarray<double> vec = {0.3, -0.7};
+  xt::xarray<double> exact =
+      xt::linalg::dot(rosen.hessian(point).value(), vec);
+
+  auto product = provider.hvp(point, vec);
+  REQUIRE_THAT(product(0), Catch::Matchers::WithinRel(exact(0), 1e-5));
+  REQUIRE_THAT(product(1), Catch::Matchers::WithinRel(exact(1), 1e-5));
+
+  SECTION("The gradient at the base point is reused") {
+    auto before = xts::optimize::eval::tally(provider).njev;
+    provider.hvp(point, xt::xarray<double>{1.0, 0.0});
+    REQUIRE(xts::optimize::eval::tally(provider).njev == before + 1);
+  }
+}
+
+TEST_CASE("Hessian-vector products by a dual pass", "[Autodiff]") {
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::autodiff::DualDirectional<xts::func::trial::D2::Rosenbrock>
+      provider(rosen);
+  xt::xarray<double> point = {-1.2, 1.0};
+  xt::xarray<double> vec = {0.3, -0.7};
+  // H = [[1200 x^2 - 400 y + 2, -400 x], [-400 x, 200]] at (-1.2, 1)
+  xt::xarray<double> exact = {1330.0 * 0.3 + 480.0 * -0.7,
+                              480.0 * 0.3 + 200.0 * -0.7};
+
+  auto product = provider.hvp(point, vec);
+  REQUIRE_THAT(product(0), Catch::Matchers::WithinRel(exact(0), 1e-12));
+  REQUIRE_THAT(product(1), Catch::Matchers::WithinRel(exact(1), 1e-12));
+  auto counts = xts::optimize::eval::tally(provider);
+  REQUIRE(counts.nhvp == 1);
+  REQUIRE(counts.njev == 0);
+  REQUIRE(counts.nhev == 0);
+}
@@ -0,0 +1,231 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cmath>
+#include <stdexcept>
+
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/linalg/ldlt.hpp"
+#include "xtsci/optimize/linalg/symmetric.hpp"
+#include "xtsci/optimize/parallel/thread_pool.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+TEST_CASE("Vector kernels", "[Kernels]") {
+  using xts::optimize::ScalarVec;
+  namespace linalg = xts::optimize::linalg;
+  const size_t ndim = 200003; // several blocks and a ragged tail
+  ScalarVec x = xt::empty<double>({ndim});
+  ScalarVec y = xt::empty<double>({ndim});
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    x(idx) = std::sin(0.1 * idx);
+    y(idx) = std::cos(0.3 * idx);
+  }
+  const double serial = linalg::dot(x, y);
+
+  SECTION("Blocked results do not depend on the number of threads") {
+    // A pool of one runs the kernels serially, as no pool does
+    const size_t nthreads = GENERATE(as<size_t>{}, 1, 2, 3, 4);
+    const double norm = linalg::nrm2(x);
+    xts::optimize::parallel::ThreadPool pool(nthreads);
+    linalg::ScopedKernelPool scope(&pool, 0);
+    REQUIRE(linalg::dot(x, y) == serial);
+    auto [xx, xy] = linalg::multi_dot(x, x, y);
+    REQUIRE(xy == serial);
+    REQUIRE(linalg::nrm2(x) == norm);
+    REQUIRE(std::sqrt(xx) == norm);
+  }
+
+  SECTION("Fused products match separate ones") {
+    auto [xx, xy] = linalg::multi_dot(x, x, y);
+    REQUIRE(xy == serial);
+    REQUIRE_THAT(std::sqrt(xx),
+                 Catch::Matchers::WithinRel(linalg::nrm2(x), 1e-15));
+  }
+
+  SECTION("Updates in place") {
+    xts::optimize::parallel::ThreadPool pool(4);
+    linalg::ScopedKernelPool scope(&pool, 0);
+    ScalarVec z = y;
+    linalg::axpy(2.0, x, z);
+    linalg::scal(0.5, z);
+    linalg::axpby(-2.0, x, 2.0, z);
+    REQUIRE_THAT(z(ndim - 1), Catch::Matchers::WithinAbs(y(ndim - 1), 1e-14));
+    REQUIRE_THAT(z(7), Catch::Matchers::WithinAbs(y(7), 1e-14));
+  }
+
+  SECTION("Operands of different sizes are refused") {
+    ScalarVec shorter = xt::zeros<double>({ndim - 1});
+    REQUIRE_THROWS_AS(linalg::dot(x, shorter), std::runtime_error);
+    REQUIRE_THROWS_AS(linalg::axpy(1.0, x, shorter), std::runtime_error);
+    REQUIRE_THROWS_AS(linalg::axpby(1.0, x, 0.0, shorter), std::runtime_error);
+    REQUIRE_THROWS_AS(linalg::copy(x, shorter), std::runtime_error);
+    REQUIRE_THROWS_AS(linalg::multi_dot(x, y, shorter), std::runtime_error);
+  }
+}
+
+TEST_CASE("Symmetric rank two kernels", "[Kernels]") {
+  using xts::optimize::ScalarMatrix;
+  using xts::optimize::ScalarVec;
+  namespace linalg = xts::optimize::linalg;
+  const size_t ndim = 9;
+  ScalarMatrix dense = xt::empty<double>({ndim, ndim});
+  ScalarVec x = xt::empty<double>({ndim});
+  ScalarVec y = xt::empty<double>({ndim});
+  for (size_t row = 0; row < ndim; ++row) {
+    x(row) = std::sin(1.0 + row);
+    y(row) = std::cos(0.5 * row);
+    for (size_t col = 0; col < ndim; ++col) {
+      dense(row, col) = 1.0 / (1.0 + row + col) + (row == col ? 2.0 : 0.0);
+    }
+  }
+  for (auto storage :
+       {linalg::SymmetricStorage::full, linalg::SymmetricStorage::packed}) {
+    linalg::SymmetricMatrix sym(0, storage);
+    sym.assign(dense);
+    ScalarVec prod = xt::empty<double>({ndim});
+    sym.symv(2.0, x, prod);
+    sym.syr2(0.25, x, y);
+    for (size_t row = 0; row < ndim; ++row) {
+      double expect = 0.0;
+      for (size_t col = 0; col < ndim; ++col) {
+        expect += 2.0 * dense(row, col) * x(col);
+        REQUIRE_THAT(sym(row, col),
+                     Catch::Matchers::WithinAbs(
+                         dense(row, col) +
+                             0.25 * (x(row) * y(col) + y(row) * x(col)),
+                         1e-14));
+      }
+      REQUIRE_THAT(prod(row), Catch::Matchers::WithinAbs(expect, 1e-13));
+    }
+  }
+  REQUIRE(linalg::SymmetricMatrix(ndim, linalg::SymmetricStorage::packed)
+              .stored() == ndim * (ndim + 1) / 2);
+}
+
+TEST_CASE("LDL^T factor updates", "[Kernels]") {
+  using xts::optimize::ScalarMatrix;
+  using xts::optimize::ScalarVec;
+  namespace linalg = xts::optimize::linalg;
+  const size_t ndim = 7;
+  linalg::LDLT factors(ndim, 2.0);
+  ScalarMatrix dense = 2.0 * xt::eye<double>(ndim);
+  ScalarVec u = xt::empty<double>({ndim});
+  ScalarVec v = xt::empty<double>({ndim});
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    u(idx) = std::sin(1.0 + idx);
+    v(idx) = std::cos(2.0 * idx);
+  }
+  // The second update leaves B indefinite
+  REQUIRE(factors.rank_one_update(0.5, u));
+  REQUIRE(factors.rank_two_update(-1.5, u, v));
+  for (size_t row = 0; row < ndim; ++row) {
+    for (size_t col = 0; col < ndim; ++col) {
+      dense(row, col) += 0.5 * u(row) * u(col) -
+                         1.5 * (u(row) * v(col) + v(row) * u(col));
+    }
+  }
+  REQUIRE(factors.negative_pivots() > 0);
+  ScalarMatrix rebuilt = factors.todense();
+  for (size_t row = 0; row < ndim; ++row) {
+    for (size_t col = row; col < ndim; ++col) {
+      REQUIRE_THAT(rebuilt(row, col),
+                   Catch::Matchers::WithinAbs(dense(row, col), 1e-13));
+    }
+  }
+
+  SECTION("Solves undo products") {
+    ScalarVec w = v;
+    factors.multiply(w);
+    REQUIRE(factors.solve(w));
+    for (size_t idx = 0; idx < ndim; ++idx) {
+      REQUIRE_THAT(w(idx), Catch::Matchers::WithinAbs(v(idx), 1e-12));
+    }
+  }
+
+  SECTION("The definite solve gives descent directions") {
+    ScalarVec dir = -u;
+    factors.solve_definite(dir);
+    REQUIRE(linalg::dot(dir, u) < 0.0);
+  }
+
+  SECTION("A cancelling update is refused") {
+    ScalarVec unit = xt::zeros<double>({ndim});
+    unit(0) = 1.0;
+    const double pivot = factors.diagonal()(0);
+    REQUIRE_FALSE(factors.rank_one_update(-pivot, unit));
+    REQUIRE(factors.diagonal()(0) == pivot);
+  }
+}
+
+TEST_CASE("Modified Cholesky", "[Kernels]") {
+  using xts::optimize::ScalarMatrix;
+  namespace linalg = xts::optimize::linalg;
+  linalg::LDLT factors;
+
+  SECTION("A positive definite matrix is factored unchanged") {
+    ScalarMatrix hess = {{4.0, 1.0, 0.5}, {1.0, 3.0, 0.2}, {0.5, 0.2, 2.0}};
+    REQUIRE(factors.modified_cholesky(hess) == 0.0);
+    ScalarMatrix rebuilt = factors.todense();
+    for (size_t row = 0; row < 3; ++row) {
+      for (size_t col = row; col < 3; ++col) {
+        REQUIRE_THAT(rebuilt(row, col),
+                     Catch::Matchers::WithinAbs(hess(row, col), 1e-14));
+      }
+    }
+  }
+
+  SECTION("An indefinite matrix gains only a diagonal") {
+    ScalarMatrix hess = {{1.0, 2.0, 0.0}, {2.0, 1.0, 3.0}, {0.0, 3.0, -4.0}};
+    REQUIRE(factors.modified_cholesky(hess) > 0.0);
+    REQUIRE(factors.negative_pivots() == 0);
+    ScalarMatrix rebuilt = factors.todense();
+    for (size_t row = 0; row < 3; ++row) {
+      REQUIRE(rebuilt(row, row) >= hess(row, row));
+      for (size_t col = row + 1; col < 3; ++col) {
+        REQUIRE_THAT(rebuilt(row, col),
+                     Catch::Matchers::WithinAbs(hess(row, col), 1e-14));
+      }
+    }
+  }
+}
+
+TEST_CASE("LDL^T of a quasi-definite matrix", "[Kernels]") {
+  using xts::optimize::ScalarMatrix;
+  using xts::optimize::ScalarVec;
+  namespace linalg = xts::optimize::linalg;
+  // [-E A^T; A F] as in the L-BFGS-B middle matrix, factored in place
+  // with two negative pivots
+  ScalarMatrix mat = {{-2.0, 0.0, 1.0, 0.5},
+                      {0.0, -1.0, 0.3, 2.0},
+                      {1.0, 0.3, 3.0, 0.1},
+                      {0.5, 2.0, 0.1, 1.0}};
+  linalg::LDLT factors;
+  REQUIRE(factors.factor(mat));
+  REQUIRE(factors.negative_pivots() == 2);
+  ScalarMatrix rebuilt = factors.todense();
+  for (size_t row = 0; row < 4; ++row) {
+    for (size_t col = row; col < 4; ++col) {
+      REQUIRE_THAT(rebuilt(row, col),
+                   Catch::Matchers::WithinAbs(mat(row, col), 1e-14));
+    }
+  }
+  ScalarVec v = {1.0, -1.0, 0.5, 2.0};
+  ScalarVec w = v;
+  REQUIRE(factors.solve(w));
+  for (size_t row = 0; row < 4; ++row) {
+    double product = 0.0;
+    for (size_t col = 0; col < 4; ++col) {
+      product += mat(row, col) * w(col);
+    }
+    REQUIRE_THAT(product, Catch::Matchers::WithinAbs(v(row), 1e-13));
+  }
+
+  SECTION("A singular matrix is refused") {
+    ScalarMatrix singular = {{-1.0, 1.0}, {1.0, -1.0}};
+    REQUIRE_FALSE(factors.factor(singular));
+  }
+}
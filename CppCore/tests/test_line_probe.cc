@@ -0,0 +1,140 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <utility>
+
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/autodiff/directional.hpp"
+#include "xtsci/optimize/base.hpp"
+#include "xtsci/optimize/eval/batch.hpp"
+#include "xtsci/optimize/eval/fused.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+namespace {
+using xts::optimize::FuncVec;
+using xts::optimize::ScalarMatrix;
+using xts::optimize::ScalarType;
+using xts::optimize::ScalarVec;
+using xts::optimize::SearchState;
+
+// f = x.x / 2, which records the batches it is asked for
+class BatchedQuadratic : public xts::optimize::eval::FusedObjective,
+                         public xts::optimize::eval::BatchEvaluation {
+public:
+  xts::optimize::eval::BatchResult
+  evaluate_batch(const ScalarMatrix &points,
+                 bool with_gradients) const override {
+    batches++;
+    rows += points.shape(0);
+    gradients = with_gradients;
+    xts::optimize::eval::BatchResult result;
+    result.values = xt::empty<ScalarType>({points.shape(0)});
+    for (size_t idx = 0; idx < points.shape(0); ++idx) {
+      auto row = xt::row(points, idx);
+      result.values(idx) = 0.5 * xt::sum(row * row)();
+    }
+    if (with_gradients) {
+      result.gradients = points;
+    }
+    return result;
+  }
+
+  mutable size_t batches{0}, rows{0};
+  mutable bool gradients{false};
+
+protected:
+  xts::optimize::eval::ValueGradient
+  compute_value_and_gradient(const FuncVec &x) const override {
+    FuncVec gradient = x;
+    return {0.5 * xt::sum(x * x)(), std::move(gradient)};
+  }
+};
+} // namespace
+
+TEST_CASE("Line probes prefetch trial steps as one batch", "[LineSearch]") {
+  // phi(alpha) = ((1 - alpha)^2 + 4) / 2, phi'(alpha) = alpha - 1
+  BatchedQuadratic quadratic;
+  const SearchState line(ScalarVec{1.0, 2.0}, ScalarVec{-1.0, 0.0});
+
+  SECTION("Values") {
+    xts::optimize::LineProbe probe(quadratic, line);
+    probe.prefetch({0.5, 1.0, 0.5});
+    REQUIRE(quadratic.batches == 1);
+    REQUIRE(quadratic.rows == 2);
+    REQUIRE_FALSE(quadratic.gradients);
+    REQUIRE(probe.points().size() == 2);
+    REQUIRE_FALSE(probe.points().front().sloped);
+    REQUIRE(probe.phi(0.5) == 2.125);
+    REQUIRE(probe.phi(1.0) == 2.0);
+    // Known points are not evaluated again
+    probe.prefetch({1.0, 0.5});
+    REQUIRE(quadratic.batches == 1);
+    REQUIRE(quadratic.fused_evaluations() == 0);
+    REQUIRE(quadratic.evaluation_counts().function_evals == 0);
+  }
+
+  SECTION("Slopes") {
+    xts::optimize::LineProbe probe(quadratic, line);
+    probe.prefetch({0.5, 1.0}, true);
+    REQUIRE(quadratic.batches == 1);
+    REQUIRE(quadratic.gradients);
+    const auto &point = probe.at(0.5);
+    REQUIRE(point.has_gradient());
+    REQUIRE(point.phi_prime == -0.5);
+    REQUIRE(probe.phi_prime(1.0) == 0.0);
+    REQUIRE(quadratic.fused_evaluations() == 0);
+    REQUIRE(quadratic.evaluation_counts().gradient_evals == 0);
+  }
+
+  SECTION("Points known by value only are replaced") {
+    xts::optimize::LineProbe probe(quadratic, line);
+    REQUIRE(probe.phi(0.5) == 2.125);
+    probe.prefetch({0.5, 1.0}, true);
+    REQUIRE(quadratic.rows == 2);
+    REQUIRE(probe.points().size() == 2);
+    const auto &point = probe.at(0.5);
+    REQUIRE(point.sloped);
+    REQUIRE(point.has_gradient());
+    REQUIRE(point.phi == 2.125);
+    REQUIRE(point.phi_prime == -0.5);
+    // Sloped points are not fetched again
+    probe.prefetch({0.5, 1.0}, true);
+    REQUIRE(quadratic.batches == 1);
+  }
+
+  SECTION("A probe with slopes batches them unasked") {
+    xts::optimize::LineProbe probe(quadratic, line, true);
+    probe.prefetch({0.5});
+    REQUIRE(quadratic.gradients);
+    REQUIRE(probe.points().front().has_gradient());
+  }
+}
+
+TEST_CASE("Line probes prefetch slopes by directional passes",
+          "[LineSearch]") {
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::autodiff::DualDirectional<xts::func::trial::D2::Rosenbrock>
+      directional(rosen);
+  const SearchState line(ScalarVec{-1.2, 1.0}, ScalarVec{1.0, 0.5});
+  xts::optimize::LineProbe probe(directional, line);
+  probe.prefetch({0.1, 0.2}, true);
+
+  // One pass per trial, no gradient or batch of them
+  auto counts = xts::optimize::eval::tally(directional);
+  REQUIRE(counts.ndev == 2);
+  REQUIRE(counts.njev == 0);
+  REQUIRE(counts.nfev == 0);
+  FuncVec trial = {-1.1, 1.05};
+  auto gradient = rosen.gradient(trial).value();
+  const auto &point = probe.at(0.1);
+  REQUIRE_FALSE(point.has_gradient());
+  REQUIRE_THAT(point.phi, Catch::Matchers::WithinAbs(rosen(trial), 1e-12));
+  REQUIRE_THAT(point.phi_prime, Catch::Matchers::WithinRel(
+                                    gradient(0) + 0.5 * gradient(1), 1e-12));
+  REQUIRE(probe.points().size() == 2);
+}
@@ -0,0 +1,107 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <optional>
+#include <utility>
+
+#include "xtensor/xtensor.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linesearch/search_strategy/zoom.hpp"
+#include "xtsci/optimize/linesearch/step_size/hermite.hpp"
+#include "xtsci/optimize/minimize/newton.hpp"
+#include "xtsci/optimize/minimize/newton_cg.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+namespace {
+using xts::optimize::FuncVec;
+using xts::optimize::ScalarType;
+using xts::optimize::ScalarVec;
+using xts::optimize::SearchState;
+
+// f = x^4 / 4 - x^2 / 2 + y^2 / 2, with minima at (+-1, 0) and negative
+// curvature along x for |x| < 1 / sqrt(3)
+class DoubleWell : public xts::optimize::eval::FusedObjective {
+protected:
+  xts::optimize::eval::ValueGradient
+  compute_value_and_gradient(const FuncVec &x) const override {
+    const ScalarType xx = x(0) * x(0);
+    FuncVec gradient = {x(0) * (xx - 1.0), x(1)};
+    return {0.25 * xx * xx - 0.5 * xx + 0.5 * x(1) * x(1),
+            std::move(gradient)};
+  }
+  std::optional<FuncVec> compute_hessian(const FuncVec &x) const override {
+    return FuncVec{{3.0 * x(0) * x(0) - 1.0, 0.0}, {0.0, 1.0}};
+  }
+};
+} // namespace
+
+TEST_CASE("Newton-CG", "[Optimizers]") {
+  xts::optimize::linesearch::step_size::HermiteInterpolationStepSize hermite;
+  xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom(hermite);
+  xts::optimize::minimize::NewtonCGOptimizer optimizer(zoom);
+
+  SECTION("Converges on Rosenbrock") {
+    xts::func::trial::D2::Rosenbrock<double> rosen;
+    auto result =
+        optimizer.optimize(rosen, SearchState(ScalarVec{-1.2, 1.0},
+                                              ScalarVec{0.0, 0.0}));
+    REQUIRE(result.nit < 100);
+    REQUIRE(optimizer.cg_iterations() > 0);
+    REQUIRE(result.nhev == 0);
+    REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(1.0, 1e-5));
+    REQUIRE_THAT(result.x(1), Catch::Matchers::WithinAbs(1.0, 1e-5));
+  }
+
+  SECTION("Leaves negative curvature along steepest descent") {
+    // g.B g < 0 here, so CG stops before its first step
+    DoubleWell well;
+    auto result =
+        optimizer.optimize(well, SearchState(ScalarVec{0.1, 0.01},
+                                             ScalarVec{0.0, 0.0}));
+    REQUIRE(optimizer.negative_curvature_steps() > 0);
+    REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(1.0, 1e-5));
+    REQUIRE_THAT(result.x(1), Catch::Matchers::WithinAbs(0.0, 1e-5));
+  }
+}
+
+TEST_CASE("Newton with a modified Cholesky factor", "[Optimizers]") {
+  using xts::optimize::minimize::HessianRefresh;
+  using xts::optimize::minimize::NewtonOptimizer;
+  xts::optimize::linesearch::step_size::HermiteInterpolationStepSize hermite;
+  xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom(hermite);
+
+  SECTION("Descends from an indefinite start") {
+    // The Hessian is diag(-0.97, 1) here
+    const SearchState start(ScalarVec{0.1, 0.01}, ScalarVec{0.0, 0.0});
+    xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom_one(
+        hermite, 1e-4, 0.9, xts::optimize::OptimizeControl(1, 1e-6, false));
+    DoubleWell first;
+    NewtonOptimizer one_step(zoom_one);
+    auto stepped = one_step.optimize(first, start);
+    REQUIRE(one_step.modification() > 0.0);
+    REQUIRE(stepped.fun < first(FuncVec(start.x)));
+
+    DoubleWell well;
+    NewtonOptimizer newton(zoom);
+    auto result = newton.optimize(well, start);
+    REQUIRE(result.nit < 100);
+    REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(1.0, 1e-5));
+    REQUIRE_THAT(result.x(1), Catch::Matchers::WithinAbs(0.0, 1e-5));
+  }
+
+  SECTION("Shamanskii steps reuse each factor") {
+    // A stall ratio no step can exceed, so only the interval refreshes
+    const size_t interval = GENERATE(as<size_t>{}, 1, 3);
+    const SearchState start(ScalarVec{2.0, 1.0}, ScalarVec{0.0, 0.0});
+    DoubleWell well;
+    NewtonOptimizer newton(zoom, HessianRefresh{interval, 1e10});
+    auto result = newton.optimize(well, start);
+    REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(1.0, 1e-5));
+    REQUIRE(result.nit > interval);
+    REQUIRE(result.nhev == newton.refreshes());
+    REQUIRE(result.nhev == (result.nit + interval - 1) / interval);
+  }
+}
@@ -0,0 +1,49 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include "xtensor/xtensor.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/linesearch/search_strategy/zoom.hpp"
+#include "xtsci/optimize/linesearch/step_size/hermite.hpp"
+#include "xtsci/optimize/minimize/nlcg.hpp"
+#include "xtsci/optimize/nlcg/conjugacy/hager_zhang.hpp"
+#include "xtsci/optimize/nlcg/restart/njws.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+TEST_CASE("Hager-Zhang coefficient", "[Optimizers]") {
+  using xts::optimize::ScalarVec;
+  xts::optimize::nlcg::conjugacy::HagerZhang hager_zhang;
+  // y = (-1, 2), |y|^2 = 5, d.y = 2, y.g = 3, d.g = -2, so
+  // beta = (y - 2 d |y|^2 / d.y) . g / d.y = (3 + 10) / 2
+  xts::optimize::nlcg::ConjugacyContext ctx{
+      ScalarVec{1.0, 2.0}, ScalarVec{2.0, 0.0}, ScalarVec{-2.0, 0.0}};
+  REQUIRE_THAT(hager_zhang.computeBeta(ctx),
+               Catch::Matchers::WithinAbs(6.5, 1e-14));
+
+  SECTION("Hestenes-Stiefel after an exact line search") {
+    // d.g = 0, beta = y.g / d.y = 4 / 4
+    ctx.current_gradient = ScalarVec{0.0, 2.0};
+    REQUIRE_THAT(hager_zhang.computeBeta(ctx),
+                 Catch::Matchers::WithinAbs(1.0, 1e-14));
+  }
+}
+
+TEST_CASE("Conjugate gradients with Hager-Zhang", "[Optimizers]") {
+  using xts::optimize::ScalarVec;
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::linesearch::step_size::HermiteInterpolationStepSize hermite;
+  // A tight curvature condition, as nonlinear CG needs
+  xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom(hermite,
+                                                                  1e-4, 0.1);
+  xts::optimize::nlcg::conjugacy::HagerZhang hager_zhang;
+  xts::optimize::nlcg::restart::NJWSRestart restart;
+  xts::optimize::minimize::ConjugateGradientOptimizer optimizer(
+      zoom, hager_zhang, restart);
+  xts::optimize::SearchState start(ScalarVec{-1.2, 1.0}, ScalarVec{0.0, 0.0});
+  auto result = optimizer.optimize(rosen, start);
+  REQUIRE(result.nit < 1000);
+  REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(1.0, 1e-4));
+  REQUIRE_THAT(result.x(1), Catch::Matchers::WithinAbs(1.0, 1e-4));
+}
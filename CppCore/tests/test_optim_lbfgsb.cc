@@ -0,0 +1,37 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include "xtensor/xtensor.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/linesearch/conditions/armijo.hpp"
+#include "xtsci/optimize/linesearch/search_strategy/backtracking.hpp"
+#include "xtsci/optimize/minimize/lbfgsb.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+TEST_CASE("L-BFGS-B respects box constraints", "[Optimizers]") {
+  using xts::optimize::ScalarVec;
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::linesearch::conditions::ArmijoCondition armijo;
+  xts::optimize::linesearch::search_strategy::BacktrackingSearch backtracking(
+      armijo);
+  xts::optimize::SearchState start(ScalarVec{-1.2, 1.0}, ScalarVec{0.0, 0.0});
+
+  SECTION("Active upper bound") {
+    // The unconstrained minimum (1, 1) is outside, the bound x <= 0.5 holds
+    xts::optimize::minimize::LBFGSBOptimizer optimizer(
+        backtracking, ScalarVec{-2.0, -2.0}, ScalarVec{0.5, 2.0});
+    auto result = optimizer.optimize(rosen, start);
+    REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(0.5, 1e-10));
+    REQUIRE_THAT(result.x(1), Catch::Matchers::WithinAbs(0.25, 1e-5));
+  }
+
+  SECTION("Inactive bounds") {
+    xts::optimize::minimize::LBFGSBOptimizer optimizer(
+        backtracking, ScalarVec{-2.0, -2.0}, ScalarVec{2.0, 2.0});
+    auto result = optimizer.optimize(rosen, start);
+    REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(1.0, 1e-4));
+    REQUIRE_THAT(result.x(1), Catch::Matchers::WithinAbs(1.0, 1e-4));
+  }
+}
@@ -0,0 +1,186 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xmath.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/linesearch/search_strategy/zoom.hpp"
+#include "xtsci/optimize/linesearch/step_size/hermite.hpp"
+#include "xtsci/optimize/minimize/bfgs.hpp"
+#include "xtsci/optimize/minimize/lbfgs.hpp"
+#include "xtsci/optimize/qn/inverse_operator.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+namespace {
+using xts::optimize::ScalarMatrix;
+using xts::optimize::ScalarType;
+using xts::optimize::ScalarVec;
+using xts::optimize::SearchState;
+
+SearchState rosenbrock_start() {
+  return SearchState(ScalarVec{-1.2, 1.0}, ScalarVec{0.0, 0.0});
+}
+
+// H from gamma I and the pairs oldest first, H <- V^T H V + rho s s^T with
+// V = I - rho y s^T [NW 7.19]
+ScalarMatrix dense_inverse(const xts::optimize::qn::CurvaturePairs &pairs) {
+  const size_t ndim = pairs.s.shape(1);
+  const ScalarMatrix eye = xt::eye<ScalarType>(ndim);
+  ScalarVec s = xt::row(pairs.s, pairs.size() - 1);
+  ScalarVec y = xt::row(pairs.y, pairs.size() - 1);
+  ScalarMatrix inverse =
+      xt::linalg::vdot(s, y) / xt::linalg::vdot(y, y) * eye;
+  for (size_t idx = 0; idx < pairs.size(); ++idx) {
+    s = xt::row(pairs.s, idx);
+    y = xt::row(pairs.y, idx);
+    const ScalarType rho = 1.0 / xt::linalg::vdot(s, y);
+    ScalarMatrix factor = eye - rho * xt::linalg::outer(y, s);
+    inverse = xt::linalg::dot(xt::transpose(factor),
+                              xt::linalg::dot(inverse, factor));
+    inverse += rho * xt::linalg::outer(s, s);
+  }
+  return inverse;
+}
+
+void require_operator(const xts::optimize::linalg::LinearOperator &op,
+                      const ScalarMatrix &dense) {
+  const size_t ndim = dense.shape(0);
+  const ScalarType tol = 1e-10 * xt::amax(xt::abs(dense))();
+  REQUIRE(op.size() == ndim);
+  ScalarMatrix todense = op.todense();
+  ScalarVec v = {0.3, -0.7};
+  ScalarVec product = op.matvec(v);
+  ScalarVec expected = xt::linalg::dot(dense, v);
+  for (size_t row = 0; row < ndim; ++row) {
+    REQUIRE_THAT(product(row), Catch::Matchers::WithinAbs(expected(row), tol));
+    for (size_t col = 0; col < ndim; ++col) {
+      REQUIRE_THAT(todense(row, col),
+                   Catch::Matchers::WithinAbs(dense(row, col), tol));
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("L-BFGS with reduced precision storage", "[Optimizers]") {
+  using xts::optimize::minimize::HistoryPrecision;
+  using xts::optimize::minimize::LBFGSEngine;
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::linesearch::step_size::HermiteInterpolationStepSize hermite;
+  xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom(hermite);
+
+  xts::optimize::minimize::LBFGSOptimizer full(zoom, 6);
+  auto reference = full.optimize(rosen, rosenbrock_start());
+  REQUIRE_THAT(reference.x(0), Catch::Matchers::WithinAbs(1.0, 1e-5));
+
+  auto precision = GENERATE(HistoryPrecision::Single,
+                            HistoryPrecision::BFloat16);
+  xts::optimize::minimize::LBFGSOptimizer narrow(zoom, 6, LBFGSEngine::TwoLoop,
+                                                 precision);
+  auto result = narrow.optimize(rosen, rosenbrock_start());
+  REQUIRE(result.nit < 1000);
+  REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(1.0, 1e-5));
+  REQUIRE_THAT(result.x(1), Catch::Matchers::WithinAbs(1.0, 1e-5));
+  const size_t ratio = precision == HistoryPrecision::Single ? 2 : 4;
+  REQUIRE(narrow.history_bytes() * ratio == full.history_bytes());
+}
+
+TEST_CASE("Inverse Hessian operators match the dense inverse",
+          "[Optimizers]") {
+  using xts::optimize::minimize::LBFGSEngine;
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::linesearch::step_size::HermiteInterpolationStepSize hermite;
+  // Stopped early, with a few pairs and an inverse far from the identity
+  xts::optimize::OptimizeControl control(6, 1e-6, false);
+  control.keep_inverse_hessian = true;
+  xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom(
+      hermite, 1e-4, 0.9, control);
+
+  SECTION("Not kept unless asked for") {
+    xts::optimize::linesearch::search_strategy::ZoomLineSearch plain(
+        hermite, 1e-4, 0.9, xts::optimize::OptimizeControl(6, 1e-6, false));
+    xts::optimize::minimize::BFGSOptimizer bfgs(plain);
+    auto result = bfgs.optimize(rosen, rosenbrock_start());
+    REQUIRE(result.hess_inv_op == nullptr);
+  }
+
+  SECTION("BFGS") {
+    xts::optimize::minimize::BFGSOptimizer bfgs(zoom);
+    auto result = bfgs.optimize(rosen, rosenbrock_start());
+    require_operator(*result.hess_inv_op, bfgs.inverse_hessian_matrix());
+  }
+
+  SECTION("L-BFGS, two-loop") {
+    xts::optimize::minimize::LBFGSOptimizer lbfgs(zoom, 3);
+    auto result = lbfgs.optimize(rosen, rosenbrock_start());
+    REQUIRE(dynamic_cast<const xts::optimize::qn::HistoryInverseOperator<
+                ScalarType> *>(result.hess_inv_op.get()));
+    auto pairs = lbfgs.export_history();
+    REQUIRE(pairs.size() > 1);
+    require_operator(*result.hess_inv_op, dense_inverse(pairs));
+  }
+
+  SECTION("L-BFGS, compact") {
+    xts::optimize::minimize::LBFGSOptimizer lbfgs(zoom, 3,
+                                                  LBFGSEngine::Compact);
+    auto result = lbfgs.optimize(rosen, rosenbrock_start());
+    REQUIRE(dynamic_cast<const xts::optimize::qn::CompactInverseOperator *>(
+        result.hess_inv_op.get()));
+    auto pairs = lbfgs.export_history();
+    REQUIRE(pairs.size() > 1);
+    require_operator(*result.hess_inv_op, dense_inverse(pairs));
+  }
+}
+
+TEST_CASE("Warm starts take fewer iterations", "[Optimizers]") {
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::linesearch::step_size::HermiteInterpolationStepSize hermite;
+  xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom(hermite);
+  // The next point of a scan, close to where the first run ended
+  SearchState nearby(ScalarVec{1.2, 1.3}, ScalarVec{0.0, 0.0});
+
+  SECTION("L-BFGS") {
+    xts::optimize::minimize::LBFGSOptimizer cold(zoom, 5);
+    auto reference = cold.optimize(rosen, nearby);
+    xts::optimize::minimize::LBFGSOptimizer warm(zoom, 5);
+    warm.set_warm_start(true);
+    warm.optimize(rosen, rosenbrock_start());
+    auto result = warm.optimize(rosen, nearby);
+    REQUIRE(warm.seeded() > 0);
+    REQUIRE(result.nit < reference.nit);
+    REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(1.0, 1e-5));
+  }
+
+  SECTION("BFGS") {
+    xts::optimize::minimize::BFGSOptimizer cold(zoom);
+    auto reference = cold.optimize(rosen, nearby);
+    xts::optimize::minimize::BFGSOptimizer warm(zoom);
+    warm.set_warm_start(true);
+    warm.optimize(rosen, rosenbrock_start());
+    auto result = warm.optimize(rosen, nearby);
+    REQUIRE(warm.seeded());
+    REQUIRE(result.nit < reference.nit);
+    REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(1.0, 1e-5));
+  }
+
+  SECTION("Seeds which disagree with the first step are dropped") {
+    xts::optimize::minimize::BFGSOptimizer bfgs(zoom);
+    // Positive definite, but with curvature far from that of the problem
+    bfgs.import_inverse_hessian(1e4 * xt::eye<ScalarType>(2));
+    auto result = bfgs.optimize(rosen, nearby);
+    REQUIRE_FALSE(bfgs.seeded());
+    REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(1.0, 1e-5));
+
+    xts::optimize::minimize::LBFGSOptimizer lbfgs(zoom, 5);
+    // An exact pair of a much flatter quadratic, (x^2 + y^2) / 2000
+    xts::optimize::qn::CurvaturePairs flat{ScalarMatrix{{1.0, 0.0}},
+                                           ScalarMatrix{{1e-3, 0.0}}};
+    lbfgs.import_history(flat);
+    lbfgs.optimize(rosen, nearby);
+    REQUIRE(lbfgs.seeded() == 0);
+  }
+}
@@ -0,0 +1,132 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cmath>
+#include <filesystem>
+#include <string>
+#include <utility>
+
+#include "xtensor/xtensor.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/checkpoint.hpp"
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linesearch/search_strategy/zoom.hpp"
+#include "xtsci/optimize/linesearch/step_size/hermite.hpp"
+#include "xtsci/optimize/minimize/lsr1.hpp"
+#include "xtsci/optimize/minimize/sr1.hpp"
+#include "xtsci/optimize/minimize/sr2.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+namespace {
+using xts::optimize::FuncVec;
+using xts::optimize::OptimizeControl;
+using xts::optimize::OptimizeResult;
+using xts::optimize::ScalarMatrix;
+using xts::optimize::ScalarType;
+using xts::optimize::ScalarVec;
+using xts::optimize::SearchState;
+
+// f = x^4 / 4 - x^2 / 2 + y^2 / 2, with minima at (+-1, 0) and negative
+// curvature along x for |x| < 1 / sqrt(3)
+class DoubleWell : public xts::optimize::eval::FusedObjective {
+protected:
+  xts::optimize::eval::ValueGradient
+  compute_value_and_gradient(const FuncVec &x) const override {
+    const ScalarType xx = x(0) * x(0);
+    FuncVec gradient = {x(0) * (xx - 1.0), x(1)};
+    return {0.25 * xx * xx - 0.5 * xx + 0.5 * x(1) * x(1),
+            std::move(gradient)};
+  }
+};
+
+// A minimum reached in a sensible number of steps, each with a gradient and
+// a few values, and no Hessian
+void require_run(const OptimizeResult &result, ScalarType x0, ScalarType x1) {
+  REQUIRE(result.nit > 0);
+  REQUIRE(result.nit < 200);
+  REQUIRE(result.njev >= result.nit);
+  REQUIRE(result.nfev <= 10 * (result.nit + 1));
+  REQUIRE(result.nhev == 0);
+  REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(x0, 1e-4));
+  REQUIRE_THAT(result.x(1), Catch::Matchers::WithinAbs(x1, 1e-4));
+}
+
+template <typename Optimizer> void require_convergence() {
+  xts::optimize::linesearch::step_size::HermiteInterpolationStepSize hermite;
+  xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom(hermite);
+
+  SECTION("Rosenbrock") {
+    xts::func::trial::D2::Rosenbrock<double> rosen;
+    Optimizer optimizer(zoom);
+    auto result = optimizer.optimize(
+        rosen, SearchState(ScalarVec{-1.2, 1.0}, ScalarVec{0.0, 0.0}));
+    require_run(result, 1.0, 1.0);
+  }
+
+  SECTION("From an indefinite start") {
+    // The Hessian is diag(-0.97, 1) here, B = I moves towards x = 1
+    DoubleWell well;
+    Optimizer optimizer(zoom);
+    auto result = optimizer.optimize(
+        well, SearchState(ScalarVec{0.1, 0.01}, ScalarVec{0.0, 0.0}));
+    require_run(result, 1.0, 0.0);
+  }
+}
+} // namespace
+
+TEST_CASE("SR1 converges", "[Optimizers]") {
+  require_convergence<xts::optimize::minimize::SR1Optimizer>();
+}
+
+TEST_CASE("SR2 converges", "[Optimizers]") {
+  require_convergence<xts::optimize::minimize::SR2Optimizer>();
+}
+
+TEST_CASE("L-SR1 converges", "[Optimizers]") {
+  require_convergence<xts::optimize::minimize::LSR1Optimizer>();
+}
+
+TEST_CASE("L-SR1 recovers from a singular middle matrix", "[Optimizers]") {
+  // A run resumed with a repeated pair, which M cannot be solved with
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "xtsci_lsr1_singular.npz")
+          .string();
+  FuncVec x = {-1.2, 1.0};
+  xts::optimize::Checkpoint checkpoint;
+  checkpoint.put("x", x);
+  checkpoint.put("direction", rosen.gradient(x).value());
+  checkpoint.put_count("nit", 1);
+  checkpoint.put("lsr1_s", ScalarMatrix{{1.0, 0.0}, {1.0, 0.0}});
+  checkpoint.put("lsr1_y", ScalarMatrix{{2.0, 0.0}, {2.0, 0.0}});
+  checkpoint.put("lsr1_delta", 1.0);
+  checkpoint.save(path);
+  xts::optimize::linesearch::step_size::HermiteInterpolationStepSize hermite;
+
+  SECTION("The first step replaces the older copy") {
+    xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom(
+        hermite, 1e-4, 0.9, OptimizeControl(2, 1e-6, false));
+    xts::optimize::minimize::LSR1Optimizer lsr1(zoom, 2);
+    auto result = lsr1.resume(rosen, path);
+    REQUIRE(result.nit == 2);
+    const auto &compact = lsr1.compact();
+    REQUIRE(compact.size() == 2);
+    REQUIRE(compact.s(0)(0) == 1.0);
+    REQUIRE(compact.s(0)(1) == 0.0);
+    REQUIRE(compact.s(1)(1) != 0.0);
+    ScalarVec v = {1.0, 1.0};
+    REQUIRE(compact.apply_inverse(v));
+  }
+
+  SECTION("And the run converges") {
+    xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom(hermite);
+    xts::optimize::minimize::LSR1Optimizer lsr1(zoom, 2);
+    auto result = lsr1.resume(rosen, path);
+    REQUIRE(result.nit < 200);
+    REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(1.0, 1e-4));
+    REQUIRE_THAT(result.x(1), Catch::Matchers::WithinAbs(1.0, 1e-4));
+  }
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,112 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <unistd.h>
+
+#include <memory>
+#include <utility>
+
+#include "xtensor/xview.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/eval/adaptor.hpp"
+#include "xtsci/optimize/eval/process_pool.hpp"
+
+#include <catch2/catch_all.hpp>
+
+namespace {
+using xts::optimize::FObjFunc;
+using xts::optimize::FuncVec;
+using xts::optimize::ScalarMatrix;
+using xts::optimize::ScalarType;
+
+std::unique_ptr<FObjFunc> make_rosenbrock() {
+  return std::make_unique<xts::func::trial::D2::Rosenbrock<double>>();
+}
+
+// Kills the worker evaluating it when x(0) is huge
+class Tripwire : public xts::optimize::eval::FusedObjective {
+protected:
+  xts::optimize::eval::ValueGradient
+  compute_value_and_gradient(const FuncVec &x) const override {
+    if (x(0) > 1e6) {
+      ::_exit(1);
+    }
+    return {x(0) * x(0), FuncVec{2.0 * x(0), 0.0}};
+  }
+};
+} // namespace
+
+TEST_CASE("Process pools match serial evaluation", "[Evaluation]") {
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::eval::ProcessPoolObjective pool(make_rosenbrock, 2, 2);
+  ScalarMatrix points = {{-1.2, 1.0}, {0.0, 0.0}, {1.0, 1.0}, {0.5, -0.3}};
+
+  SECTION("Value only batches skip the gradient") {
+    auto result = pool.evaluate_batch(points, false);
+    for (size_t row = 0; row < 4; ++row) {
+      FuncVec x = xt::row(points, row);
+      REQUIRE(result.values(row) == rosen(x));
+    }
+    auto counts = xts::optimize::eval::tally(pool);
+    REQUIRE(counts.nfev == 4);
+    REQUIRE(counts.njev == 0);
+  }
+
+  SECTION("Fused batches carry both") {
+    auto result = pool.evaluate_batch(points, true);
+    for (size_t row = 0; row < 4; ++row) {
+      FuncVec x = xt::row(points, row);
+      REQUIRE(result.values(row) == rosen(x));
+      REQUIRE(FuncVec(xt::row(result.gradients, row)) ==
+              rosen.gradient(x).value());
+    }
+    REQUIRE(pool.fused_evaluations() == 4);
+  }
+
+  SECTION("Single points") {
+    FuncVec x = {-1.2, 1.0};
+    REQUIRE(pool(x) == rosen(x));
+    REQUIRE(pool.fused_evaluations() == 0);
+    auto [value, gradient] = xts::optimize::eval::value_and_gradient(pool, x);
+    REQUIRE(value == rosen(x));
+    REQUIRE(gradient == rosen.gradient(x).value());
+    REQUIRE(pool.fused_evaluations() == 1);
+  }
+}
+
+TEST_CASE("A dead worker is reported, not fatal", "[Evaluation]") {
+  xts::optimize::eval::ProcessPoolObjective pool(
+      []() -> std::unique_ptr<FObjFunc> {
+        return std::make_unique<Tripwire>();
+      },
+      2, 1);
+  REQUIRE(pool(FuncVec{3.0, 0.0}) == 9.0);
+  REQUIRE_THROWS_WITH(pool(FuncVec{1e7, 0.0}),
+                      "Lost contact with a worker process.");
+  // It is dropped rather than written to again, which would raise SIGPIPE
+  // with plain pipes
+  REQUIRE(pool.size() == 0);
+  REQUIRE_THROWS_WITH(pool(FuncVec{3.0, 0.0}), "No worker processes left.");
+}
+
+TEST_CASE("The other workers survive one dying mid-batch", "[Evaluation]") {
+  xts::optimize::eval::ProcessPoolObjective pool(
+      []() -> std::unique_ptr<FObjFunc> {
+        return std::make_unique<Tripwire>();
+      },
+      2, 3);
+  // One row each, the middle worker dies while the others reply
+  ScalarMatrix points = {{1.0, 0.0}, {1e7, 0.0}, {2.0, 0.0}};
+  REQUIRE_THROWS_WITH(pool.evaluate_batch(points, false),
+                      "Lost contact with a worker process.");
+  REQUIRE(pool.size() == 2);
+
+  // Stale replies of the failed round would be read as this one's
+  ScalarMatrix next = {{3.0, 0.0}, {4.0, 0.0}, {5.0, 0.0}, {6.0, 0.0}};
+  auto result = pool.evaluate_batch(next, true);
+  for (size_t row = 0; row < 4; ++row) {
+    REQUIRE(result.values(row) == next(row, 0) * next(row, 0));
+    REQUIRE(result.gradients(row, 0) == 2.0 * next(row, 0));
+  }
+  REQUIRE(pool(FuncVec{7.0, 0.0}) == 49.0);
+}
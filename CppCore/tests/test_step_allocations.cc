@@ -0,0 +1,107 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "xtensor/xtensor.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/minimize/lbfgs.hpp"
+#include "xtsci/optimize/minimize/nlcg.hpp"
+#include "xtsci/optimize/nlcg/conjugacy/fletcher_reeves.hpp"
+#include "xtsci/optimize/nlcg/restart/never.hpp"
+
+#include <catch2/catch_all.hpp>
+
+// Every heap allocation of the test binary goes through here
+namespace {
+std::atomic<size_t> g_allocations{0};
+} // namespace
+
+void *operator new(std::size_t size) {
+  g_allocations++;
+  if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+using xts::optimize::FObjFunc;
+using xts::optimize::LineProbe;
+using xts::optimize::ScalarVec;
+
+// A search of a single probe, whose allocations (those of the probe and the
+// evaluation it makes) are the same every step and so can be subtracted.
+// Real searches allocate a varying amount, which is not measured here.
+class FixedStep : public xts::optimize::SearchStrategy {
+public:
+  FixedStep() : SearchStrategy(xts::optimize::OptimizeControl()) {}
+
+protected:
+  LineProbe::Point run(const xts::optimize::AlphaState,
+                       LineProbe &probe) override {
+    return probe.take(1e-3);
+  }
+};
+
+template <typename Optimizer> class Stepped : public Optimizer {
+public:
+  using Optimizer::Optimizer;
+  void advance(const FObjFunc &func) {
+    this->step(func);
+    this->m_result.nit++;
+  }
+};
+
+// Allocations made by n steps beyond those of their line searches and the
+// evaluations at the new iterates, i.e. by the optimizer's own bookkeeping
+template <typename Optimizer>
+long excess_allocations(Optimizer &optimizer, FixedStep &search,
+                        const FObjFunc &func, size_t nsteps) {
+  xts::optimize::FuncVec point = {-1.0, 1.0};
+  xts::optimize::SearchState line(ScalarVec{-1.0, 1.0}, ScalarVec{1.0, 0.0});
+  size_t before = g_allocations;
+  // As the optimizers call them, seeded with the start of the step
+  search.search({1, 1e-6, 1}, func, line,
+                {0.0, 1.0, -1.0, xts::optimize::FuncVec{}});
+  xts::optimize::eval::value_and_gradient(func, point);
+  const size_t per_step = g_allocations - before;
+  before = g_allocations;
+  for (size_t idx = 0; idx < nsteps; ++idx) {
+    optimizer.advance(func);
+  }
+  return static_cast<long>(g_allocations - before) -
+         static_cast<long>(nsteps * per_step);
+}
+} // namespace
+
+TEST_CASE("Steady state bookkeeping does not allocate", "[Optimizers]") {
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  FixedStep fixed;
+  xts::optimize::SearchState start(ScalarVec{-1.2, 1.0}, ScalarVec{0.0, 0.0});
+
+  SECTION("L-BFGS") {
+    Stepped<xts::optimize::minimize::LBFGSOptimizer> optimizer(fixed, 3);
+    optimizer.set_initial(start);
+    // Past the first step and a full history
+    for (size_t idx = 0; idx < 5; ++idx) {
+      optimizer.advance(rosen);
+    }
+    REQUIRE(excess_allocations(optimizer, fixed, rosen, 10) == 0);
+  }
+
+  SECTION("Conjugate gradients") {
+    xts::optimize::nlcg::conjugacy::FletcherReeves fletcher_reeves;
+    xts::optimize::nlcg::restart::NeverRestart never;
+    Stepped<xts::optimize::minimize::ConjugateGradientOptimizer> optimizer(
+        fixed, fletcher_reeves, never);
+    optimizer.set_initial(start);
+    optimizer.advance(rosen);
+    REQUIRE(excess_allocations(optimizer, fixed, rosen, 10) == 0);
+  }
+}
@@ -0,0 +1,205 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <atomic>
+#include <future>
+#include <utility>
+#include <vector>
+
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/eval/adaptor.hpp"
+#include "xtsci/optimize/eval/batch.hpp"
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linesearch/conditions/armijo.hpp"
+#include "xtsci/optimize/linesearch/search_strategy/backtracking.hpp"
+#include "xtsci/optimize/linesearch/search_strategy/zoom.hpp"
+#include "xtsci/optimize/linesearch/step_size/bisect.hpp"
+#include "xtsci/optimize/parallel/thread_pool.hpp"
+
+#include <catch2/catch_all.hpp>
+
+namespace {
+using xts::optimize::FuncVec;
+using xts::optimize::ScalarMatrix;
+using xts::optimize::ScalarType;
+using xts::optimize::SearchState;
+
+// Stateless, counted atomically through value_and_gradient
+class SharedRosenbrock : public xts::optimize::eval::FusedObjective,
+                         public xts::optimize::eval::ConcurrentEvaluation {
+protected:
+  xts::optimize::eval::ValueGradient
+  compute_value_and_gradient(const FuncVec &x) const override {
+    const ScalarType valley = x(1) - x(0) * x(0);
+    FuncVec gradient = {-400.0 * x(0) * valley - 2.0 * (1.0 - x(0)),
+                        200.0 * valley};
+    return {100.0 * valley * valley + (1.0 - x(0)) * (1.0 - x(0)),
+            std::move(gradient)};
+  }
+};
+} // namespace
+
+TEST_CASE("Nested parallel loops run inline on a worker", "[Parallel]") {
+  // A single worker would wait on itself if the inner loop were queued
+  xts::optimize::parallel::ThreadPool pool(1);
+
+  SECTION("parallel_for inside a task") {
+    std::atomic<size_t> sum{0};
+    bool inside = pool.submit([&]() {
+                        pool.parallel_for(8, [&](size_t idx) { sum += idx; });
+                        return pool.on_worker();
+                      })
+                      .get();
+    REQUIRE(inside);
+    REQUIRE(sum == 28);
+    REQUIRE_FALSE(pool.on_worker());
+  }
+
+  SECTION("parallel_for inside parallel_for") {
+    std::vector<size_t> counts(4, 0);
+    pool.parallel_for(4, [&](size_t outer) {
+      pool.parallel_for(3, [&](size_t) { counts[outer]++; });
+    });
+    REQUIRE(counts == std::vector<size_t>(4, 3));
+  }
+
+  SECTION("A pooled batch inside a task matches the serial one") {
+    SharedRosenbrock rosen;
+    ScalarMatrix points = {{-1.2, 1.0}, {0.0, 0.0}, {1.0, 1.0}, {0.5, -0.3}};
+    auto serial = xts::optimize::eval::evaluate_batch(rosen, points, true);
+    auto nested = pool.submit([&]() {
+                        return xts::optimize::eval::evaluate_batch(
+                            rosen, points, true, pool);
+                      })
+                      .get();
+    REQUIRE(nested.values == serial.values);
+    REQUIRE(nested.gradients == serial.gradients);
+    REQUIRE(rosen.fused_evaluations() == 8);
+  }
+}
+
+TEST_CASE("Pooled batches need a concurrent objective", "[Parallel]") {
+  xts::optimize::parallel::ThreadPool pool(4);
+  ScalarMatrix points = {{-1.2, 1.0}, {0.0, 0.0}, {1.0, 1.0}, {0.5, -0.3}};
+
+  SECTION("Plain objectives are evaluated serially") {
+    xts::func::trial::D2::Rosenbrock<double> rosen;
+    auto result = xts::optimize::eval::evaluate_batch(rosen, points, false,
+                                                      pool);
+    REQUIRE(result.values(1) == 1.0);
+    REQUIRE(rosen.evaluation_counts().function_evals == 4);
+  }
+
+  SECTION("Declared ones on the pool, with exact counts") {
+    SharedRosenbrock rosen;
+    ScalarMatrix many = xt::empty<ScalarType>({256, 2});
+    for (size_t row = 0; row < 256; ++row) {
+      xt::row(many, row) = xt::row(points, row % 4);
+    }
+    auto result = xts::optimize::eval::evaluate_batch(rosen, many, true, pool);
+    REQUIRE(result.values(5) == 1.0);
+    REQUIRE(rosen.fused_evaluations() == 256);
+  }
+}
+
+TEST_CASE("Speculative line searches", "[Parallel]") {
+  xts::optimize::linesearch::step_size::BisectionStepSize bisect;
+  xts::optimize::linesearch::search_strategy::ZoomLineSearch zoom(bisect);
+  FuncVec x = {-1.2, 1.0};
+  FuncVec direction = {215.6, 88.0}; // -grad f(x)
+  SearchState line = {x, direction};
+  const xts::optimize::AlphaState alphas{1e-5, 0.0, 1.0};
+
+  SharedRosenbrock plain;
+  auto reference = zoom.search(alphas, plain, line);
+  REQUIRE(plain.fused_evaluations() > 2);
+
+  SECTION("Accept the same step") {
+    xts::optimize::parallel::ThreadPool pool(4);
+    zoom.set_speculation(pool, 3);
+    SharedRosenbrock rosen;
+    auto accepted = zoom.search(alphas, rosen, line);
+    REQUIRE(accepted.alpha == reference.alpha);
+    REQUIRE(accepted.has_gradient() == reference.has_gradient());
+    if (reference.has_gradient()) {
+      REQUIRE(accepted.phi == reference.phi);
+      REQUIRE(accepted.gradient == reference.gradient);
+    }
+    REQUIRE(rosen.fused_evaluations() >= plain.fused_evaluations());
+  }
+
+  SECTION("Speculations which never start are not evaluated") {
+    // The only worker is held until the search is over, so the probe
+    // evaluates everything itself and the queued tasks find them claimed
+    xts::optimize::parallel::ThreadPool pool(1);
+    std::promise<void> gate;
+    auto held = pool.submit([opened = gate.get_future()]() { opened.wait(); });
+    zoom.set_speculation(pool, 3);
+    SharedRosenbrock rosen;
+    auto accepted = zoom.search(alphas, rosen, line);
+    gate.set_value();
+    held.get();
+    REQUIRE(accepted.alpha == reference.alpha);
+    REQUIRE(rosen.fused_evaluations() == plain.fused_evaluations());
+  }
+
+  SECTION("Plain objectives are not speculated on") {
+    xts::optimize::parallel::ThreadPool pool(1);
+    std::promise<void> gate;
+    auto held = pool.submit([opened = gate.get_future()]() { opened.wait(); });
+    zoom.set_speculation(pool, 3);
+    xts::func::trial::D2::Rosenbrock<double> rosen;
+    auto accepted = zoom.search(alphas, rosen, line);
+    gate.set_value();
+    held.get();
+    REQUIRE(accepted.alpha == reference.alpha);
+  }
+}
+
+TEST_CASE("Speculative value only searches", "[Parallel]") {
+  xts::optimize::linesearch::conditions::ArmijoCondition armijo;
+  xts::optimize::linesearch::search_strategy::BacktrackingSearch backtracking(
+      armijo);
+  FuncVec x = {-1.2, 1.0};
+  FuncVec direction = {215.6, 88.0}; // -grad f(x), many halvings from 1
+  SearchState line = {x, direction};
+  const xts::optimize::AlphaState alphas{1.0, 0.0, 1.0};
+
+  SharedRosenbrock plain;
+  auto reference = backtracking.search(alphas, plain, line);
+  const auto plain_counts = xts::optimize::eval::tally(plain);
+  REQUIRE(plain_counts.nfev > 2);
+
+  SECTION("Accept the same step, counting every value") {
+    xts::optimize::parallel::ThreadPool pool(4);
+    backtracking.set_speculation(pool, 3);
+    SharedRosenbrock rosen;
+    auto accepted = backtracking.search(alphas, rosen, line);
+    REQUIRE(accepted.alpha == reference.alpha);
+    REQUIRE(accepted.phi == reference.phi);
+    // The pool's values are counted apart from those of the probe's thread,
+    // never through the plain counter
+    auto counts = xts::optimize::eval::tally(rosen);
+    REQUIRE(counts.nfev == rosen.evaluation_counts().function_evals +
+                               rosen.value_evaluations());
+    REQUIRE(counts.nfev >= plain_counts.nfev);
+    REQUIRE(rosen.fused_evaluations() == 0);
+    REQUIRE(counts.njev == plain_counts.njev);
+  }
+
+  SECTION("Speculations which never start are not evaluated") {
+    xts::optimize::parallel::ThreadPool pool(1);
+    std::promise<void> gate;
+    auto held = pool.submit([opened = gate.get_future()]() { opened.wait(); });
+    backtracking.set_speculation(pool, 3);
+    SharedRosenbrock rosen;
+    auto accepted = backtracking.search(alphas, rosen, line);
+    gate.set_value();
+    held.get();
+    REQUIRE(accepted.alpha == reference.alpha);
+    REQUIRE(rosen.value_evaluations() == 0);
+    REQUIRE(xts::optimize::eval::tally(rosen).nfev == plain_counts.nfev);
+  }
+}
@@ -0,0 +1,81 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtsci/func/trial/D2/rosenbrock.hpp"
+#include "xtsci/optimize/minimize/trust_region.hpp"
+#include "xtsci/optimize/trust/model.hpp"
+#include "xtsci/optimize/trust/subproblem.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+namespace {
+void require_minimum(xts::optimize::trust::HessianModel &model,
+                     xts::optimize::trust::SubproblemSolver &solver) {
+  using xts::optimize::ScalarVec;
+  xts::func::trial::D2::Rosenbrock<double> rosen;
+  xts::optimize::OptimizeControl control;
+  xts::optimize::minimize::TrustRegionOptimizer optimizer(model, solver,
+                                                          control);
+  xts::optimize::SearchState start(ScalarVec{-1.2, 1.0}, ScalarVec{0.0, 0.0});
+  auto result = optimizer.optimize(rosen, start);
+  REQUIRE(result.nit < control.max_iterations);
+  REQUIRE_THAT(result.x(0), Catch::Matchers::WithinAbs(1.0, 1e-5));
+  REQUIRE_THAT(result.x(1), Catch::Matchers::WithinAbs(1.0, 1e-5));
+}
+} // namespace
+
+TEST_CASE("Trust region models and subproblems", "[Optimizers]") {
+  namespace trust = xts::optimize::trust;
+
+  SECTION("Dense SR1 with the exact subproblem") {
+    trust::DenseSR1Model model;
+    trust::ExactSubproblem solver;
+    require_minimum(model, solver);
+  }
+
+  SECTION("Dense BFGS with the dogleg") {
+    trust::DenseBFGSModel model;
+    trust::Dogleg solver;
+    require_minimum(model, solver);
+  }
+
+  SECTION("Limited memory SR1 with Steihaug CG") {
+    trust::CompactSR1Model model(3);
+    trust::SteihaugCG solver;
+    require_minimum(model, solver);
+  }
+
+  SECTION("Hessian-vector products with Steihaug CG") {
+    trust::HessianVectorModel model;
+    trust::SteihaugCG solver;
+    require_minimum(model, solver);
+  }
+}
+
+TEST_CASE("Exact subproblem in the hard case", "[Optimizers]") {
+  using xts::optimize::ScalarMatrix;
+  using xts::optimize::ScalarVec;
+  namespace trust = xts::optimize::trust;
+  // B = diag(-2, 1) with g orthogonal to the negative curvature direction
+  class Diagonal : public trust::HessianModel {
+  public:
+    void reset(size_t) override {}
+    void multiply(const ScalarVec &v, ScalarVec &out) const override {
+      out(0) = -2.0 * v(0);
+      out(1) = v(1);
+    }
+    size_t size() const override { return 2; }
+  } model;
+  trust::ExactSubproblem solver;
+  ScalarVec gradient{0.0, 0.5};
+  ScalarVec step = xt::zeros<double>({2});
+  auto result = solver.solve(model, gradient, 1.0, step);
+  REQUIRE(result.boundary);
+  REQUIRE_THAT(xt::linalg::norm(step), Catch::Matchers::WithinAbs(1.0, 1e-12));
+  // p = -(B + 2 I)^-1 g in the second component, the rest along e_0
+  REQUIRE_THAT(step(1), Catch::Matchers::WithinAbs(-0.5 / 3.0, 1e-12));
+  REQUIRE(result.predicted > 0.0);
+}
@@ -15,6 +15,7 @@
 
 #include "xtensor/xbuilder.hpp"
 #include "xtsci/optimize/base.hpp"
+#include "xtsci/optimize/eval/cache.hpp"
 #include "xtsci/optimize/linesearch/conditions/armijo.hpp"
 #include "xtsci/optimize/linesearch/conditions/goldstein.hpp"
 #include "xtsci/optimize/linesearch/conditions/wolfe.hpp"
@@ -42,9 +43,9 @@
 #include "xtsci/optimize/linesearch/step_size/secant.hpp"
 
 // #include "xtsci/optimize/minimize/adam.hpp"
-// #include "xtsci/optimize/minimize/bfgs.hpp"
+#include "xtsci/optimize/minimize/bfgs.hpp"
 #include "xtsci/optimize/minimize/lbfgs.hpp"
-// #include "xtsci/optimize/minimize/nlcg.hpp"
+#include "xtsci/optimize/minimize/nlcg.hpp"
 // #include "xtsci/optimize/minimize/pso.hpp"
 // #include "xtsci/optimize/minimize/sd.hpp"
 // #include "xtsci/optimize/minimize/sr1.hpp"
@@ -154,7 +155,11 @@ int main(int argc, char *argv[]) {
   // control);
 
   auto cuh2pot = std::make_shared<rgpot::CuH2Pot>();
-  auto CuH2Obj = xts::pot::mk_xtpot_con("cuh2.con", cuh2pot);
+  auto CuH2Pot = xts::pot::mk_xtpot_con("cuh2.con", cuh2pot);
+  // To see which call sites ask for the same point twice, wrap the potential
+  // in an xts::optimize::eval::EvaluationLedger and call report(std::cout)
+  // Line searches revisit points, don't pay for the potential twice
+  xts::optimize::eval::CachedObjective CuH2Obj(CuH2Pot);
 
   xt::xarray<double> initial_guess = {
       8.68229999999999968, 9.94699999999999918, 4.75760000000000094,
@@ -188,5 +193,7 @@ int main(int argc, char *argv[]) {
   // std::cout << "Number of gradient evaluations: " << result.njev << "\n";
   // std::cout << "Number of Hessian evaluations: " << result.nhev << "\n";
   // std::cout << "Unique function and gradient calls: " << result.nufg << "\n";
+  // std::cout << "Cached function and gradient calls: " << result.nfev_cached
+  //           << ", " << result.njev_cached << "\n";
   return EXIT_SUCCESS;
 }
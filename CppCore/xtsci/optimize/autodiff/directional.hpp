@@ -0,0 +1,86 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+
+#include "xtsci/func/base.hpp"
+#include "xtsci/optimize/autodiff/dual.hpp"
+#include "xtsci/optimize/eval/adaptor.hpp"
+#include "xtsci/optimize/eval/hvp.hpp"
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+namespace autodiff {
+
+// Gives line searches phi and phi' from one dual evaluation of a templated
+// objective, e.g. DualDirectional<trial::D2::Rosenbrock> over a
+// Rosenbrock<double>. Costs roughly two function evaluations per probe,
+// independent of the dimension. Values, gradients and Hessians still come
+// from the wrapped primal objective, so caches belong inside this adaptor.
+//
+// The same seeding pushed through the gradient of the dual objective gives
+// Hessian-vector products (forward over the analytic gradient) at the cost of
+// about two gradients, exact to rounding and without an O(n^2) Hessian.
+template <template <typename> class Objective>
+class DualDirectional : public eval::ObjectiveAdaptor,
+                        public eval::DirectionalEvaluation,
+                        public eval::HessianVectorProduct {
+public:
+  using DualScalar = Dual<ScalarType>;
+
+  explicit DualDirectional(const FObjFunc &primal,
+                           Objective<DualScalar> dual = {})
+      : ObjectiveAdaptor(primal), m_dual(std::move(dual)) {}
+
+  std::pair<ScalarType, ScalarType>
+  value_and_directional(const FuncVec &x,
+                        const FuncVec &direction) const override {
+    m_directional_evals++;
+    DualScalar result = m_dual(seed(x, direction));
+    return {result.val, result.eps};
+  }
+
+  FuncVec hvp(const FuncVec &x, const FuncVec &v) const override {
+    auto dual_gradient = m_dual.gradient(seed(x, v));
+    if (!dual_gradient) {
+      throw std::runtime_error("Gradient required for Hessian-vector product.");
+    }
+    m_hvp_evals++;
+    FuncVec product = xt::empty<ScalarType>(dual_gradient->shape());
+    for (size_t idx = 0; idx < product.size(); ++idx) {
+      product.flat(idx) = dual_gradient->flat(idx).eps;
+    }
+    return product;
+  }
+
+  void tally(eval::EvaluationTally &counts) const override {
+    ObjectiveAdaptor::tally(counts);
+    counts.ndev += m_directional_evals;
+    counts.nhvp += m_hvp_evals;
+  }
+
+private:
+  Objective<DualScalar> m_dual;
+  mutable std::atomic<size_t> m_directional_evals{0}, m_hvp_evals{0};
+
+  // x + t * direction with the direction in the infinitesimal part
+  static xt::xarray<DualScalar> seed(const FuncVec &x,
+                                     const FuncVec &direction) {
+    xt::xarray<DualScalar> seeded = xt::empty<DualScalar>(x.shape());
+    for (size_t idx = 0; idx < x.size(); ++idx) {
+      seeded.flat(idx) = DualScalar(x.flat(idx), direction.flat(idx));
+    }
+    return seeded;
+  }
+};
+
+} // namespace autodiff
+} // namespace optimize
+} // namespace xts
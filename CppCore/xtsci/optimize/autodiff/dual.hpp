@@ -0,0 +1,123 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cmath>
+#include <ostream>
+
+namespace xts {
+namespace optimize {
+namespace autodiff {
+
+// Forward mode dual number val + eps * e with e^2 = 0. Evaluating f on
+// x + t * d with the eps parts set to d gives f(x) and grad f(x) . d together.
+//
+// Objectives templated on their scalar type work unchanged as long as they
+// call the math functions unqualified (using std::sin; sin(x);) so that the
+// overloads below are found by argument dependent lookup.
+template <typename T> struct Dual {
+  T val;
+  T eps;
+
+  Dual(T value = T(0), T derivative = T(0)) // NOLINT(runtime/explicit)
+      : val(value), eps(derivative) {}
+
+  Dual &operator+=(const Dual &other) {
+    val += other.val;
+    eps += other.eps;
+    return *this;
+  }
+  Dual &operator-=(const Dual &other) {
+    val -= other.val;
+    eps -= other.eps;
+    return *this;
+  }
+  Dual &operator*=(const Dual &other) {
+    eps = eps * other.val + val * other.eps;
+    val *= other.val;
+    return *this;
+  }
+  Dual &operator/=(const Dual &other) {
+    eps = (eps * other.val - val * other.eps) / (other.val * other.val);
+    val /= other.val;
+    return *this;
+  }
+
+  // Hidden friends, so that mixed Dual and scalar arithmetic converts
+  friend Dual operator+(Dual lhs, const Dual &rhs) { return lhs += rhs; }
+  friend Dual operator-(Dual lhs, const Dual &rhs) { return lhs -= rhs; }
+  friend Dual operator*(Dual lhs, const Dual &rhs) { return lhs *= rhs; }
+  friend Dual operator/(Dual lhs, const Dual &rhs) { return lhs /= rhs; }
+  friend Dual operator-(const Dual &arg) { return {-arg.val, -arg.eps}; }
+  friend Dual operator+(const Dual &arg) { return arg; }
+
+  // Comparisons only see the value, branches follow the primal computation
+  friend bool operator==(const Dual &lhs, const Dual &rhs) {
+    return lhs.val == rhs.val;
+  }
+  friend bool operator!=(const Dual &lhs, const Dual &rhs) {
+    return lhs.val != rhs.val;
+  }
+  friend bool operator<(const Dual &lhs, const Dual &rhs) {
+    return lhs.val < rhs.val;
+  }
+  friend bool operator<=(const Dual &lhs, const Dual &rhs) {
+    return lhs.val <= rhs.val;
+  }
+  friend bool operator>(const Dual &lhs, const Dual &rhs) {
+    return lhs.val > rhs.val;
+  }
+  friend bool operator>=(const Dual &lhs, const Dual &rhs) {
+    return lhs.val >= rhs.val;
+  }
+
+  friend std::ostream &operator<<(std::ostream &out, const Dual &arg) {
+    return out << arg.val << " + " << arg.eps << "e";
+  }
+
+  // Elementary functions, f(a + b e) = f(a) + f'(a) b e
+  friend Dual sqrt(const Dual &arg) {
+    T root = std::sqrt(arg.val);
+    return {root, arg.eps / (T(2) * root)};
+  }
+  friend Dual exp(const Dual &arg) {
+    T value = std::exp(arg.val);
+    return {value, value * arg.eps};
+  }
+  friend Dual log(const Dual &arg) {
+    return {std::log(arg.val), arg.eps / arg.val};
+  }
+  friend Dual sin(const Dual &arg) {
+    return {std::sin(arg.val), std::cos(arg.val) * arg.eps};
+  }
+  friend Dual cos(const Dual &arg) {
+    return {std::cos(arg.val), -std::sin(arg.val) * arg.eps};
+  }
+  friend Dual tan(const Dual &arg) {
+    T value = std::tan(arg.val);
+    return {value, (T(1) + value * value) * arg.eps};
+  }
+  friend Dual atan(const Dual &arg) {
+    return {std::atan(arg.val), arg.eps / (T(1) + arg.val * arg.val)};
+  }
+  friend Dual tanh(const Dual &arg) {
+    T value = std::tanh(arg.val);
+    return {value, (T(1) - value * value) * arg.eps};
+  }
+  friend Dual abs(const Dual &arg) { return arg.val < T(0) ? -arg : arg; }
+  friend Dual fabs(const Dual &arg) { return abs(arg); }
+  friend Dual pow(const Dual &base, const T &power) {
+    return {std::pow(base.val, power),
+            power * std::pow(base.val, power - T(1)) * base.eps};
+  }
+  friend Dual pow(const Dual &base, const Dual &power) {
+    // A constant exponent, e.g. a promoted literal, allows a negative base
+    if (power.eps == T(0)) {
+      return pow(base, power.val);
+    }
+    return exp(power * log(base));
+  }
+};
+
+} // namespace autodiff
+} // namespace optimize
+} // namespace xts
@@ -1,13 +1,196 @@
 // MIT License
 // Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
 #include "xtsci/optimize/base.hpp"
+#include "xtsci/optimize/eval/batch.hpp"
 
 namespace xts::optimize {
 
+namespace {
+// Off the calling thread (concurrent) phi goes through the atomically counted
+// entry points, see eval::ConcurrentEvaluation
+LineProbe::Point evaluate_point(const FObjFunc &func, const FuncVec &x,
+                                const FuncVec &direction, ScalarType alpha,
+                                bool with_slope, bool concurrent = false) {
+  FuncVec trial = x + alpha * direction;
+  if (!with_slope) {
+    const ScalarType phi =
+        concurrent ? eval::concurrent_value(func, trial) : func(trial);
+    return {alpha, phi, 0.0, FuncVec{}, false};
+  }
+  if (auto directional =
+          dynamic_cast<const eval::DirectionalEvaluation *>(&func)) {
+    auto [value, slope] = directional->value_and_directional(trial, direction);
+    return {alpha, value, slope, FuncVec{}};
+  }
+  auto [value, gradient] = eval::value_and_gradient(func, trial);
+  ScalarType slope = xt::linalg::dot(gradient, direction)();
+  return {alpha, value, slope, std::move(gradient)};
+}
+} // namespace
+
+LineProbe::~LineProbe() {
+  for (auto &speculation : m_speculations) {
+    if (speculation.claimed->exchange(true)) {
+      speculation.result.wait();
+    }
+  }
+}
+
+bool LineProbe::pending(ScalarType alpha) const {
+  return std::any_of(
+      m_speculations.begin(), m_speculations.end(),
+      [alpha](const Speculation &spec) { return spec.alpha == alpha; });
+}
+
+LineProbe::Point *LineProbe::find(ScalarType alpha) {
+  for (auto &point : m_points) {
+    if (point.alpha == alpha) {
+      return &point;
+    }
+  }
+  return nullptr;
+}
+
+LineProbe::Point &LineProbe::evaluate(ScalarType alpha, bool slope) {
+  Point *point = find(alpha);
+  if (point == nullptr) {
+    auto speculated = std::find_if(
+        m_speculations.begin(), m_speculations.end(),
+        [alpha](const Speculation &spec) { return spec.alpha == alpha; });
+    // Waits for a speculation which is running or done, takes over one which
+    // has not started
+    std::optional<std::future<std::optional<Point>>> running;
+    if (speculated != m_speculations.end()) {
+      if (speculated->claimed->exchange(true)) {
+        running = std::move(speculated->result);
+      }
+      m_speculations.erase(speculated);
+    }
+    if (running) {
+      m_points.push_back(std::move(*running->get()));
+    } else {
+      const auto &[x, direction] = m_state.get();
+      m_points.push_back(evaluate_point(m_func.get(), x, direction, alpha,
+                                        slope || m_slopes));
+    }
+    point = &m_points.back();
+  }
+  if (slope && !point->sloped) {
+    add_slope(*point);
+  }
+  return *point;
+}
+
+void LineProbe::add_slope(Point &point) const {
+  const auto &[x, direction] = m_state.get();
+  FuncVec trial = x + point.alpha * direction;
+  const auto &func = m_func.get();
+  if (auto directional =
+          dynamic_cast<const eval::DirectionalEvaluation *>(&func)) {
+    point.phi_prime =
+        directional->value_and_directional(trial, direction).second;
+  } else {
+    auto gradient = func.gradient(trial);
+    if (!gradient) {
+      throw std::runtime_error("Gradient required for the line search slope.");
+    }
+    point.phi_prime = xt::linalg::dot(*gradient, direction)();
+    point.gradient = std::move(*gradient);
+  }
+  point.sloped = true;
+}
+
+void LineProbe::speculate(const std::vector<ScalarType> &alphas,
+                          parallel::ThreadPool &pool) {
+  if (!eval::concurrent(m_func.get())) {
+    return;
+  }
+  const auto &[x, direction] = m_state.get();
+  for (auto alpha : alphas) {
+    if (find(alpha) || pending(alpha)) {
+      continue;
+    }
+    auto claimed = std::make_shared<std::atomic<bool>>(false);
+    auto result = pool.submit(
+        [&func = m_func.get(), claimed, x = FuncVec(x),
+         direction = FuncVec(direction), alpha, slope = m_slopes,
+         tag = eval::ScopedCallSite::current()]() -> std::optional<Point> {
+          if (claimed->exchange(true)) {
+            return std::nullopt;
+          }
+          eval::ScopedCallSite site(tag);
+          return evaluate_point(func, x, direction, alpha, slope, true);
+        });
+    m_speculations.push_back({alpha, std::move(claimed), std::move(result)});
+  }
+}
+
+void LineProbe::record(Point point) {
+  if (!find(point.alpha)) {
+    m_points.push_back(std::move(point));
+  }
+}
+
+LineProbe::Point LineProbe::take(ScalarType alpha) {
+  if (auto known = find(alpha)) {
+    return std::move(*known);
+  }
+  const ScalarType nan = std::numeric_limits<ScalarType>::quiet_NaN();
+  return {alpha, nan, nan, FuncVec{}, false};
+}
+
+void LineProbe::prefetch(const std::vector<ScalarType> &alphas,
+                         bool with_slopes) {
+  const bool slopes = with_slopes || m_slopes;
+  std::vector<ScalarType> fresh;
+  for (auto alpha : alphas) {
+    auto known = find(alpha);
+    if ((known && (known->sloped || !slopes)) || pending(alpha) ||
+        std::find(fresh.begin(), fresh.end(), alpha) != fresh.end()) {
+      continue;
+    }
+    fresh.push_back(alpha);
+  }
+  if (fresh.empty()) {
+    return;
+  }
+  // A directional pass is already cheaper than a batched gradient
+  if (slopes &&
+      dynamic_cast<const eval::DirectionalEvaluation *>(&m_func.get())) {
+    for (auto alpha : fresh) {
+      at(alpha);
+    }
+    return;
+  }
+  const auto &[x, direction] = m_state.get();
+  ScalarMatrix trials = xt::empty<ScalarType>({fresh.size(), x.size()});
+  for (size_t idx = 0; idx < fresh.size(); ++idx) {
+    xt::row(trials, idx) = x + fresh[idx] * direction;
+  }
+  auto batch = eval::evaluate_batch(m_func.get(), trials, slopes);
+  for (size_t idx = 0; idx < fresh.size(); ++idx) {
+    Point point{fresh[idx], batch.values(idx), 0.0, FuncVec{}, slopes};
+    if (slopes) {
+      point.gradient = xt::row(batch.gradients, idx);
+      point.phi_prime = xt::linalg::dot(point.gradient, direction)();
+    }
+    // Points known by value only are replaced by the full evaluation
+    if (auto known = find(fresh[idx])) {
+      *known = std::move(point);
+    } else {
+      m_points.push_back(std::move(point));
+    }
+  }
+}
+
 bool AbstractOptimizer::converged(const SearchState &state) const {
   // std::cout << m_next->direction << std::endl;
   if (m_result.nit > 2) {
-    return xt::linalg::norm(m_next->direction) < m_control.get().gtol;
+    return linalg::nrm2(m_next->direction) < m_control.get().gtol;
   }
   return false;
 }
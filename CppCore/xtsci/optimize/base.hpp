@@ -2,7 +2,12 @@
 // MIT License
 // Copyright 2023--present Rohit Goswami <HaoZeke>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <deque>
 #include <functional>
+#include <future>
+#include <initializer_list>
 #include <limits>
 #include <memory>
 #include <mutex>
@@ -13,9 +18,16 @@
 #include <vector>
 
 #include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
 
 #include "xtsci/func/base.hpp"
+#include "xtsci/optimize/checkpoint.hpp"
+#include "xtsci/optimize/eval/adaptor.hpp"
+#include "xtsci/optimize/eval/call_site.hpp"
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/linalg/linear_operator.hpp"
 #include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/parallel/thread_pool.hpp"
 
 namespace xts {
 namespace optimize {
@@ -29,10 +41,18 @@ struct OptimizeResult {
   ScalarMatrix jac;      // value of the Jacobian at the solution
   ScalarMatrix hess;     // value of the Hessian at the solution
   ScalarMatrix hess_inv; // inverse of the Hessian at the solution
+  // The approximate inverse Hessian of quasi-Newton methods, applied lazily,
+  // todense() gives hess_inv when n is small enough. Only set with
+  // OptimizeControl::keep_inverse_hessian
+  std::shared_ptr<const linalg::LinearOperator> hess_inv_op;
   size_t nfev;           // number of evaluations of the objective functions
   size_t njev;           // number of evaluations of the Jacobian
   size_t nhev;           // number of evaluations of the Hessian
   size_t nufg;           // number of unique function and gradient evaluations
+  size_t nfev_cached;    // function evaluations served from a cache
+  size_t njev_cached;    // Jacobian evaluations served from a cache
+  size_t ndev;           // number of directional (value and slope) evaluations
+  size_t nhvp;           // number of Hessian-vector products from a dual pass
   size_t nit;            // number of iterations performed by the optimizer
   ScalarType maxcv;      // the maximum constraint violation
 };
@@ -45,6 +65,12 @@ struct OptimizeControl {
   ScalarType xtol = 1e-6;       // Change in x threshold
   ScalarType ftol = 1e-6;       // Change in f(x) threshold
   ScalarType gtol = 1e-6;       // Change in f'(x) threshold
+  // Iterations between checkpoints written to checkpoint_path, 0 for none
+  size_t checkpoint_interval = 0;
+  std::string checkpoint_path = "optimizer_checkpoint.npz";
+  // Whether results carry hess_inv_op, a copy of the method's (possibly
+  // dense) inverse Hessian taken by every get_result
+  bool keep_inverse_hessian = false;
   OptimizeControl(const size_t miter_val, const ScalarType tol_val,
                   const bool verb_val)
       : max_iterations{miter_val}, tol{tol_val}, verbose{verb_val} {}
@@ -59,34 +85,172 @@ struct SearchState {
       : x(x), direction(direction) {}
 };
 
+// Vectors reused by every step of a run, sized by set_initial. The
+// optimizer's own work in a step which only writes into these (e.g. with
+// the linalg kernels) does not allocate, its evaluations and line search may.
+struct StepWorkspace {
+  SearchState line{ScalarVec{}, ScalarVec{}}; // passed to the line search
+  ScalarVec gradient;                         // at line.x
+  ScalarVec s;                                // step taken
+  ScalarVec y;                                // change in the gradient
+  FuncVec point; // argument of the objective, saves a conversion per call
+  // f at line.x, known from the previous step (or a checkpoint)
+  std::optional<ScalarType> energy;
+
+  void resize(size_t ndim) {
+    for (auto *vec : {&line.x, &line.direction, &gradient, &s, &y}) {
+      if (vec->size() != ndim) {
+        *vec = xt::zeros<ScalarType>({ndim});
+      }
+    }
+    if (point.size() != ndim) {
+      point = xt::zeros<ScalarType>({ndim});
+    }
+  }
+};
+
 struct AlphaState {
   ScalarType init;
   ScalarType low;
   ScalarType hi;
 };
 
+// Evaluations of phi(alpha) = f(x + alpha * direction) made during a single
+// line search, shared by its conditions and step size strategies so that no
+// trial point is evaluated twice. The optimizers record f and grad f at x,
+// known from their previous step, as alpha = 0, and take the accepted point
+// back with its evaluation for the next iterate.
+//
+// phi alone is a plain call of the objective, phi' is only added when asked
+// for, so searches which test values only never need a gradient. With slopes
+// set every trial is evaluated for both at once instead, which suits searches
+// testing the curvature at each trial.
+class LineProbe {
+public:
+  struct Point {
+    ScalarType alpha;
+    ScalarType phi;       // f(x + alpha * direction)
+    ScalarType phi_prime; // grad f(x + alpha * direction) . direction
+    FuncVec gradient;     // 0-D unless grad f was evaluated, see below
+    bool sloped{true};    // false while only phi is known
+    // False for points known by value only, or whose phi_prime came from a
+    // directional pass
+    bool has_gradient() const { return gradient.dimension() == 1; }
+  };
+
+  LineProbe(const FObjFunc &func, const SearchState &cstate,
+            bool slopes = false)
+      : m_func(func), m_state(cstate), m_slopes(slopes) {}
+  // Cancels speculative evaluations which have not started, waits for the
+  // running ones since they use the objective
+  ~LineProbe();
+
+  // phi and phi' at the trial point, each evaluated on the first request only
+  const Point &at(ScalarType alpha) { return evaluate(alpha, true); }
+  // Evaluates all the new alphas as one batch, with their slopes if asked
+  void prefetch(const std::vector<ScalarType> &alphas,
+                bool with_slopes = false);
+  // Starts evaluating the new alphas on the pool and returns at once, at()
+  // then waits only for the point it needs, or evaluates it itself when its
+  // turn on the pool has not come. Nothing is speculated unless the objective
+  // is eval::concurrent(), whose counted entry points the pool then uses.
+  void speculate(const std::vector<ScalarType> &alphas,
+                 parallel::ThreadPool &pool);
+  // Adds an evaluation made elsewhere, e.g. by the previous iteration
+  void record(Point point);
+  // Moves the point at alpha out for the caller of the search, with a NaN
+  // phi when alpha was never evaluated
+  Point take(ScalarType alpha);
+  ScalarType phi(ScalarType alpha) { return evaluate(alpha, false).phi; }
+  ScalarType phi_prime(ScalarType alpha) { return at(alpha).phi_prime; }
+  ScalarType phi_0() { return evaluate(0.0, false).phi; }
+  ScalarType phi_prime_0() { return at(0.0).phi_prime; }
+
+  const FObjFunc &func() const { return m_func.get(); }
+  const SearchState &state() const { return m_state.get(); }
+  const std::deque<Point> &points() const { return m_points; }
+
+private:
+  std::reference_wrapper<const FObjFunc> m_func;
+  std::reference_wrapper<const SearchState> m_state;
+  bool m_slopes;
+  Point *find(ScalarType alpha);
+  bool pending(ScalarType alpha) const;
+  Point &evaluate(ScalarType alpha, bool slope);
+  void add_slope(Point &point) const;
+  // A deque keeps references from at() valid as points are added
+  std::deque<Point> m_points;
+  struct Speculation {
+    ScalarType alpha;
+    // Set by whichever of the task and the probe gets to it first, the task
+    // evaluates nothing when the probe did
+    std::shared_ptr<std::atomic<bool>> claimed;
+    std::future<std::optional<Point>> result; // empty when claimed
+  };
+  std::vector<Speculation> m_speculations;
+};
+
 class StepSizeStrategy {
 public:
-  virtual ScalarType nextStep(const AlphaState alpha, const FObjFunc &func,
-                              const SearchState &cstate) const = 0;
+  virtual ScalarType nextStep(const AlphaState alpha,
+                              LineProbe &probe) const = 0;
 };
 
 class SearchCondition {
 public:
-  virtual bool operator()(ScalarType alpha, const FObjFunc &func,
-                          const SearchState &cstate) const = 0;
+  // Whether check() reads phi' at the trial step, the line search then
+  // evaluates trial steps for both phi and phi' at once
+  virtual bool needs_slope() const { return false; }
+  bool operator()(ScalarType alpha, LineProbe &probe) const {
+    return check(alpha, probe);
+  }
+  // Standalone check, without evaluations from an ongoing search
+  bool operator()(ScalarType alpha, const FObjFunc &func,
+                  const SearchState &cstate) const {
+    LineProbe probe(func, cstate);
+    return check(alpha, probe);
+  }
+  virtual bool check(ScalarType alpha, LineProbe &probe) const = 0;
 };
 
 class SearchStrategy {
 protected:
   friend class AbstractOptimizer;
   OptimizeControl m_control;
+  // Speculative evaluation of upcoming trial steps, off unless set
+  parallel::ThreadPool *m_pool{nullptr};
+  size_t m_speculation{0};
+
+  // The line search proper, on a probe which may already hold evaluations
+  virtual LineProbe::Point run(const AlphaState _in, LineProbe &probe) = 0;
+  // Whether the trial steps are tested on phi', see LineProbe
+  virtual bool slopes() const { return false; }
 
 public:
   explicit SearchStrategy(const OptimizeControl &control)
       : m_control(control) {}
-  virtual ScalarType search(const AlphaState _in, const FObjFunc &func,
-                            const SearchState &cstate) = 0;
+  // The accepted step, with what the search evaluated there (see
+  // LineProbe::take), so the caller need not evaluate it again
+  LineProbe::Point search(const AlphaState _in, const FObjFunc &func,
+                          const SearchState &cstate) {
+    LineProbe probe(func, cstate, slopes());
+    return run(_in, probe);
+  }
+  // As above, with f and grad f at x already known to the caller as origin,
+  // whose alpha is 0
+  LineProbe::Point search(const AlphaState _in, const FObjFunc &func,
+                          const SearchState &cstate, LineProbe::Point origin) {
+    LineProbe probe(func, cstate, slopes());
+    probe.record(std::move(origin));
+    return run(_in, probe);
+  }
+  // Evaluates up to depth trial steps beyond the current one concurrently,
+  // the results which are not needed are discarded. Only for objectives
+  // declaring eval::ConcurrentEvaluation, see LineProbe::speculate
+  void set_speculation(parallel::ThreadPool &pool, size_t depth) {
+    m_pool = &pool;
+    m_speculation = depth;
+  }
 };
 
 class AbstractOptimizer {
@@ -94,7 +258,12 @@ public:
   // Virtual destructor for proper cleanup of derived classes
   virtual ~AbstractOptimizer() = default;
   explicit AbstractOptimizer(SearchStrategy &strategy)
-      : m_strat(strategy), m_control{strategy.m_control} {}
+      : m_strat(&strategy), m_control{strategy.m_control} {}
+  // For methods which choose their steps without a line search, e.g. trust
+  // regions, the control is then held by the optimizer
+  explicit AbstractOptimizer(const OptimizeControl &control)
+      : m_own_control(std::make_unique<OptimizeControl>(control)),
+        m_control{*m_own_control} {}
   explicit AbstractOptimizer(SearchStrategy &strategy, SearchState initial)
       : AbstractOptimizer(strategy) {
     set_initial(initial);
@@ -102,40 +271,82 @@ public:
 
   void set_initial(const SearchState &initial) {
     std::unique_lock<std::mutex> lock(m_mutex);
-    m_cur = std::make_unique<SearchState>(initial);
-    m_next = std::make_unique<SearchState>(initial);
+    start(initial);
+    m_result = OptimizeResult{};
     lock.unlock();
   }
 
+  // Vector kernels of the following runs use pool for n >= threshold
+  void set_kernel_pool(parallel::ThreadPool &pool,
+                       size_t threshold = linalg::kernel_threshold) {
+    m_kernel_pool = &pool;
+    m_kernel_threshold = threshold;
+  }
+
   virtual OptimizeResult optimize(const FObjFunc &func,
                                   const SearchState &state) {
+    linalg::ScopedKernelPool kernels(m_kernel_pool, m_kernel_threshold);
     set_initial(state);
-    if (m_control.get().verbose) {
-      // Print the headers in the desired format
-      std::cout << "       Step     Time       Energy       fmax\n";
+    return iterate(func, state);
+  }
+
+  // Continues a run from a checkpoint written by the same kind of optimizer,
+  // following the same path the interrupted run would have taken
+  OptimizeResult resume(const FObjFunc &func, const std::string &path) {
+    linalg::ScopedKernelPool kernels(m_kernel_pool, m_kernel_threshold);
+    auto checkpoint = Checkpoint::load(path);
+    SearchState state(checkpoint.vec("x"), checkpoint.vec("direction"));
+    std::unique_lock<std::mutex> lock(m_mutex);
+    start(state);
+    m_result = OptimizeResult{};
+    m_result.nit = checkpoint.count("nit");
+    lock.unlock();
+    load_state(checkpoint);
+    if (checkpoint.contains("energy")) {
+      m_ws.energy = checkpoint.scalar("energy");
     }
-    while (m_result.nit < m_control.get().max_iterations &&
-           !this->converged(state)) {
-      this->step(func);
-      m_result.nit++;
+    return iterate(func, state);
+  }
+
+  // Writes the state needed by resume()
+  void checkpoint(const std::string &path) const {
+    Checkpoint checkpoint;
+    checkpoint.put("x", m_next->x);
+    checkpoint.put("direction", m_next->direction);
+    checkpoint.put_count("nit", m_result.nit);
+    if (m_ws.energy) {
+      checkpoint.put("energy", *m_ws.energy);
     }
-    return get_result(func);
+    save_state(checkpoint);
+    checkpoint.save(path);
   }
 
   OptimizeResult get_result(const FObjFunc &func) const {
+    eval::ScopedCallSite site("get_result");
     m_result.x = m_next->x;
-    m_result.fun = func(m_next->x);
-    m_result.jac = *func.gradient(m_next->x);
-    m_result.nfev = func.evaluation_counts().function_evals;
-    m_result.njev = func.evaluation_counts().gradient_evals;
-    m_result.nhev = func.evaluation_counts().hessian_evals;
-    m_result.nufg = func.evaluation_counts().unique_func_grad;
+    auto [fun, jac] = eval::value_and_gradient(func, m_next->x);
+    m_result.fun = fun;
+    m_result.jac = jac;
+    // Raw counts are those of the potential, not the adaptors around it
+    auto counts = eval::tally(func);
+    m_result.nfev = counts.nfev;
+    m_result.njev = counts.njev;
+    m_result.nhev = counts.nhev;
+    m_result.nufg = counts.nufg;
+    m_result.nfev_cached = counts.nfev_cached;
+    m_result.njev_cached = counts.njev_cached;
+    m_result.ndev = counts.ndev;
+    m_result.nhvp = counts.nhvp;
+    m_result.hess_inv_op = m_control.get().keep_inverse_hessian
+                               ? inverse_hessian()
+                               : nullptr;
     return m_result;
   }
 
   virtual void step(const FObjFunc &func) = 0;
   // TODO(rg): this is pointless, just modify maxmove
   ScalarVec step_from(FObjFunc &func, SearchState &state, size_t for_n = 1) {
+    linalg::ScopedKernelPool kernels(m_kernel_pool, m_kernel_threshold);
     set_initial(state);
     if (m_control.get().verbose) {
       // Print the headers in the desired format
@@ -151,12 +362,166 @@ public:
 protected:
   std::unique_ptr<SearchState> m_cur, m_next;
   std::mutex m_mutex;
-  std::reference_wrapper<SearchStrategy> m_strat;
+  SearchStrategy *m_strat{nullptr};
+  std::unique_ptr<OptimizeControl> m_own_control;
   const std::reference_wrapper<OptimizeControl> m_control;
-  mutable OptimizeResult m_result;
+  mutable OptimizeResult m_result{};
+  StepWorkspace m_ws;
+  parallel::ThreadPool *m_kernel_pool{nullptr};
+  size_t m_kernel_threshold{linalg::kernel_threshold};
+
+  // Method specific state for checkpoints, the iterate and the iteration
+  // count are handled here. Steps after load_state must match those the
+  // saved optimizer would have taken.
+  virtual void save_state(Checkpoint &) const {}
+  virtual void load_state(const Checkpoint &) {}
+
+  // Snapshot of the method's inverse Hessian approximation, if it has one
+  virtual std::shared_ptr<const linalg::LinearOperator>
+  inverse_hessian() const {
+    return nullptr;
+  }
+
+  // The line search, which optimizers built from a control alone lack
+  SearchStrategy &strategy() const {
+    if (m_strat == nullptr) {
+      throw std::runtime_error("Optimizer has no line search strategy.");
+    }
+    return *m_strat;
+  }
+
+  // The line search along line, handed f and grad f at line.x so that
+  // alpha = 0 is not evaluated again; f comes from the previous step, the
+  // first step evaluates it
+  LineProbe::Point line_search(const FObjFunc &func, const AlphaState in,
+                               const SearchState &line,
+                               const ScalarVec &gradient) {
+    if (!m_ws.energy) {
+      m_ws.energy = func(line.x);
+    }
+    LineProbe::Point origin{0.0, *m_ws.energy,
+                            linalg::dot(gradient, line.direction), FuncVec{}};
+    return strategy().search(in, func, line, std::move(origin));
+  }
+
+  // f and grad f at the new iterate x, at step alpha along the line search
+  // direction. What the search evaluated at its accepted step is reused when
+  // alpha is that step, f is kept for the next line search.
+  eval::ValueGradient accept(const FObjFunc &func, LineProbe::Point &&point,
+                             ScalarType alpha, const FuncVec &x) {
+    if (point.alpha == alpha && point.has_gradient()) {
+      m_ws.energy = point.phi;
+      return {point.phi, std::move(point.gradient)};
+    }
+    if (point.alpha == alpha && !std::isnan(point.phi)) {
+      auto gradient = func.gradient(x);
+      if (!gradient) {
+        throw std::runtime_error("Gradient required at the accepted step.");
+      }
+      m_ws.energy = point.phi;
+      return {point.phi, std::move(*gradient)};
+    }
+    auto result = eval::value_and_gradient(func, x);
+    m_ws.energy = result.value;
+    return result;
+  }
+
+  // grad f at x, for the named method which cannot do without it
+  ScalarVec get_gradient(const FObjFunc &func, const ScalarVec &x,
+                         const std::string &method) const {
+    auto grad_opt = func.gradient(x);
+    if (!grad_opt) {
+      throw std::runtime_error("Gradient required for " + method +
+                               " method.");
+    }
+    return *grad_opt;
+  }
+
+  // Starts a step at the end point of the previous one, with x in ws.line.x
+  // and, after the first step, grad f there in ws.gradient from the state
+  // direction. Returns whether this is the first step, which has no gradient
+  // yet and sets up the method's state.
+  bool begin_step() {
+    std::swap(m_cur, m_next);
+    linalg::copy(m_cur->x, m_ws.line.x);
+    if (m_result.nit == 0) {
+      return true;
+    }
+    linalg::copy(m_cur->direction, m_ws.gradient);
+    return false;
+  }
+  // As above, evaluating grad f on the first step
+  bool begin_step(const FObjFunc &func, const std::string &method) {
+    if (!begin_step()) {
+      return false;
+    }
+    linalg::copy(get_gradient(func, m_ws.line.x, method), m_ws.gradient);
+    return true;
+  }
+
+  // The line search along ws.line.direction and the move to its step: ws.s
+  // holds alpha * direction, ws.point and m_next the new x with grad f there,
+  // ws.y the change in the gradient and ws.energy f. Steps longer than
+  // maxmove are scaled down. Returns alpha.
+  ScalarType
+  take_step(const FObjFunc &func, const AlphaState in,
+            ScalarType maxmove = std::numeric_limits<ScalarType>::infinity()) {
+    auto &ws = m_ws;
+    auto accepted = line_search(func, in, ws.line, ws.gradient);
+    ScalarType alpha = accepted.alpha;
+    if (std::isfinite(maxmove)) {
+      const ScalarType step_norm = alpha * linalg::nrm2(ws.line.direction);
+      if (step_norm > maxmove) {
+        alpha *= maxmove / step_norm;
+      }
+    }
+    linalg::copy(ws.line.direction, ws.s);
+    linalg::scal(alpha, ws.s);
+    linalg::copy(ws.line.x, ws.point);
+    linalg::axpy(1.0, ws.s, ws.point);
+    auto n_grad = accept(func, std::move(accepted), alpha, ws.point).gradient;
+    linalg::copy(ws.point, m_next->x);
+    linalg::copy(n_grad, m_next->direction);
+    linalg::copy(n_grad, ws.y);
+    linalg::axpy(-1.0, ws.gradient, ws.y);
+    return alpha;
+  }
 
   // Method to check convergence (can be overridden for custom behavior)
-  bool converged(const SearchState &state) const;
+  virtual bool converged(const SearchState &state) const;
+
+private:
+  // The states double as storage for the iterates, their direction as the
+  // gradient, so both are kept the size of x
+  void start(const SearchState &initial) {
+    m_cur = std::make_unique<SearchState>(initial);
+    m_next = std::make_unique<SearchState>(initial);
+    const size_t ndim = initial.x.size();
+    if (initial.direction.size() != ndim) {
+      m_cur->direction = xt::zeros<ScalarType>({ndim});
+      m_next->direction = xt::zeros<ScalarType>({ndim});
+    }
+    m_ws.resize(ndim);
+    m_ws.energy.reset();
+  }
+
+  OptimizeResult iterate(const FObjFunc &func, const SearchState &state) {
+    const auto &control = m_control.get();
+    if (control.verbose) {
+      // Print the headers in the desired format
+      std::cout << "       Step     Time       Energy       fmax\n";
+    }
+    while (m_result.nit < control.max_iterations &&
+           !this->converged(state)) {
+      this->step(func);
+      m_result.nit++;
+      if (control.checkpoint_interval > 0 &&
+          m_result.nit % control.checkpoint_interval == 0) {
+        checkpoint(control.checkpoint_path);
+      }
+    }
+    return get_result(func);
+  }
 };
 
 } // namespace optimize
@@ -0,0 +1,67 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "xtensor-io/xnpz.hpp"
+#include "xtensor/xadapt.hpp"
+
+#include "xtsci/optimize/checkpoint.hpp"
+
+namespace xts::optimize {
+
+void Checkpoint::put_rng(const std::string &name, const std::mt19937 &rng) {
+  // The textual state is the only portable view of the engine, its words
+  // are 32 bit and so exact as doubles
+  std::stringstream stream;
+  stream << rng;
+  std::vector<ScalarType> words;
+  uint64_t word = 0;
+  while (stream >> word) {
+    words.push_back(static_cast<ScalarType>(word));
+  }
+  put(name, xt::adapt(words, {words.size()}));
+}
+
+void Checkpoint::get_rng(const std::string &name, std::mt19937 &rng) const {
+  std::stringstream stream;
+  for (auto word : array(name)) {
+    stream << static_cast<uint64_t>(word) << ' ';
+  }
+  stream >> rng;
+  if (stream.fail()) {
+    throw std::runtime_error("Checkpoint holds no valid RNG state: " + name);
+  }
+}
+
+const xt::xarray<ScalarType> &
+Checkpoint::array(const std::string &name) const {
+  auto found = m_arrays.find(name);
+  if (found == m_arrays.end()) {
+    throw std::runtime_error("Checkpoint has no entry " + name);
+  }
+  return found->second;
+}
+
+void Checkpoint::save(const std::string &path) const {
+  const std::string partial = path + ".partial";
+  std::filesystem::remove(partial);
+  for (const auto &[name, values] : m_arrays) {
+    xt::dump_npz(partial, name, values, false, true);
+  }
+  std::filesystem::rename(partial, path);
+}
+
+Checkpoint Checkpoint::load(const std::string &path) {
+  Checkpoint checkpoint;
+  auto npz = xt::load_npz(path);
+  for (auto &[name, file] : npz) {
+    checkpoint.m_arrays[name] = file.cast<ScalarType>();
+  }
+  return checkpoint;
+}
+
+} // namespace xts::optimize
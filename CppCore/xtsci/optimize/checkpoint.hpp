@@ -0,0 +1,56 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "xtensor/xarray.hpp"
+
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+
+// Named arrays making up the state of an optimizer, kept in one .npz file.
+// Everything is stored as double, counts are exact up to 2^53.
+class Checkpoint {
+public:
+  void put(const std::string &name, const xt::xarray<ScalarType> &array) {
+    m_arrays[name] = array;
+  }
+  void put(const std::string &name, ScalarType value) {
+    m_arrays[name] = xt::xarray<ScalarType>(std::vector<size_t>{1}, value);
+  }
+  void put_count(const std::string &name, size_t count) {
+    put(name, static_cast<ScalarType>(count));
+  }
+  // The full Mersenne Twister state, so random draws continue unchanged
+  void put_rng(const std::string &name, const std::mt19937 &rng);
+
+  bool contains(const std::string &name) const {
+    return m_arrays.count(name) > 0;
+  }
+  // Throw when name was never stored
+  const xt::xarray<ScalarType> &array(const std::string &name) const;
+  ScalarVec vec(const std::string &name) const { return array(name); }
+  ScalarMatrix matrix(const std::string &name) const { return array(name); }
+  ScalarType scalar(const std::string &name) const { return array(name)(0); }
+  size_t count(const std::string &name) const {
+    return static_cast<size_t>(scalar(name));
+  }
+  void get_rng(const std::string &name, std::mt19937 &rng) const;
+
+  // Writes next to path and renames, so an interrupted save leaves the
+  // previous checkpoint intact
+  void save(const std::string &path) const;
+  static Checkpoint load(const std::string &path);
+
+private:
+  std::map<std::string, xt::xarray<ScalarType>> m_arrays;
+};
+
+} // namespace optimize
+} // namespace xts
@@ -0,0 +1,40 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include "xtsci/optimize/eval/adaptor.hpp"
+
+namespace xts::optimize::eval {
+
+void ObjectiveAdaptor::tally(EvaluationTally &counts) const {
+  if (auto adaptor = dynamic_cast<const ObjectiveAdaptor *>(&inner())) {
+    adaptor->tally(counts);
+    return;
+  }
+  add_raw_counts(inner(), counts);
+}
+
+void add_raw_counts(const FObjFunc &func, EvaluationTally &counts) {
+  auto raw = func.evaluation_counts();
+  counts.nfev += raw.function_evals;
+  counts.njev += raw.gradient_evals;
+  counts.nhev += raw.hessian_evals;
+  counts.nufg += raw.unique_func_grad;
+  // A fused call is a single potential call yielding both quantities
+  if (auto fused = dynamic_cast<const FusedObjective *>(&func)) {
+    counts.nfev += fused->fused_evaluations();
+    counts.njev += fused->fused_evaluations();
+    counts.nufg += fused->fused_evaluations();
+    counts.nfev += fused->value_evaluations();
+  }
+}
+
+EvaluationTally tally(const FObjFunc &func) {
+  EvaluationTally counts;
+  if (auto adaptor = dynamic_cast<const ObjectiveAdaptor *>(&func)) {
+    adaptor->tally(counts);
+    return counts;
+  }
+  add_raw_counts(func, counts);
+  return counts;
+}
+
+} // namespace xts::optimize::eval
@@ -0,0 +1,74 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+#include <functional>
+#include <optional>
+
+#include "xtensor/xarray.hpp"
+
+#include "xtsci/func/base.hpp"
+#include "xtsci/optimize/eval/batch.hpp"
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+namespace eval {
+
+// Evaluation counts as seen by the underlying potential, plus the requests
+// which were served without calling it
+struct EvaluationTally {
+  size_t nfev = 0;        // raw objective function calls
+  size_t njev = 0;        // raw gradient calls
+  size_t nhev = 0;        // raw Hessian calls
+  size_t nufg = 0;        // raw unique function and gradient calls
+  size_t nfev_cached = 0; // function requests served from a cache
+  size_t njev_cached = 0; // gradient requests served from a cache
+  size_t ndev = 0;        // directional (value and slope) evaluations
+  size_t nhvp = 0;        // Hessian-vector products from a dual pass
+};
+
+// An objective which forwards to another objective, the base for all the
+// evaluation wrappers (caches, ledgers, finite differences...)
+class ObjectiveAdaptor : public FObjFunc,
+                         public FusedEvaluation,
+                         public BatchEvaluation {
+public:
+  explicit ObjectiveAdaptor(const FObjFunc &inner) : m_inner(inner) {}
+  const FObjFunc &inner() const { return m_inner.get(); }
+
+  ValueGradient value_and_gradient(const FuncVec &x) const override {
+    return eval::value_and_gradient(m_inner.get(), x);
+  }
+  BatchResult evaluate_batch(const ScalarMatrix &points,
+                             bool with_gradients) const override {
+    return eval::evaluate_batch(m_inner.get(), points, with_gradients);
+  }
+
+  // Accumulates the counts of the wrapped objective, adaptors which serve
+  // requests themselves add to the relevant fields
+  virtual void tally(EvaluationTally &counts) const;
+
+protected:
+  std::reference_wrapper<const FObjFunc> m_inner;
+
+  ScalarType compute(const FuncVec &x) const override {
+    return m_inner.get()(x);
+  }
+  std::optional<FuncVec> compute_gradient(const FuncVec &x) const override {
+    return m_inner.get().gradient(x);
+  }
+  std::optional<FuncVec> compute_hessian(const FuncVec &x) const override {
+    return m_inner.get().hessian(x);
+  }
+};
+
+// Counts for any objective, walking through adaptors to the potential
+EvaluationTally tally(const FObjFunc &func);
+// Adds the counts reported by a potential which is not an adaptor
+void add_raw_counts(const FObjFunc &func, EvaluationTally &counts);
+
+} // namespace eval
+} // namespace optimize
+} // namespace xts
@@ -0,0 +1,118 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtsci/func/base.hpp"
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/parallel/thread_pool.hpp"
+
+namespace xts {
+namespace optimize {
+namespace eval {
+
+struct BatchResult {
+  ScalarVec values;       // One per row of the input
+  ScalarMatrix gradients; // Same shape as the input, empty unless requested
+};
+
+// Implemented by objectives which can amortize setup (neighbor lists, BLAS,
+// crossing an FFI boundary) over several points, one point per row
+class BatchEvaluation {
+public:
+  virtual ~BatchEvaluation() = default;
+  virtual BatchResult evaluate_batch(const ScalarMatrix &points,
+                                     bool with_gradients) const = 0;
+};
+
+// Implemented by objectives which may be evaluated from several threads at
+// once. This covers their call counters too: those of FObjFunc are plain
+// integers, so e.g. a FusedObjective is only safe through value_and_gradient
+// and value_only, which it counts atomically. Those which are also a
+// DirectionalEvaluation must count value_and_directional the same way.
+class ConcurrentEvaluation {
+public:
+  virtual ~ConcurrentEvaluation() = default;
+};
+
+// Whether func may be called from several threads, which also needs entry
+// points that do not touch the counters of FObjFunc
+inline bool concurrent(const FObjFunc &func) {
+  return dynamic_cast<const ConcurrentEvaluation *>(&func) != nullptr &&
+         dynamic_cast<const FusedEvaluation *>(&func) != nullptr;
+}
+
+// f(x) for a concurrent func, through those entry points
+inline ScalarType concurrent_value(const FObjFunc &func, const FuncVec &x) {
+  if (auto fused = dynamic_cast<const FusedObjective *>(&func)) {
+    return fused->value_only(x);
+  }
+  const auto &fused = dynamic_cast<const FusedEvaluation &>(func);
+  return fused.value_and_gradient(x).value;
+}
+
+// Evaluates every row of points, falling back to one call per row
+inline BatchResult evaluate_batch(const FObjFunc &func,
+                                  const ScalarMatrix &points,
+                                  bool with_gradients = false) {
+  if (auto batched = dynamic_cast<const BatchEvaluation *>(&func)) {
+    return batched->evaluate_batch(points, with_gradients);
+  }
+  const size_t npoints = points.shape(0);
+  BatchResult result;
+  result.values = xt::empty<ScalarType>({npoints});
+  if (with_gradients) {
+    result.gradients = xt::empty<ScalarType>(points.shape());
+  }
+  for (size_t idx = 0; idx < npoints; ++idx) {
+    FuncVec x = xt::row(points, idx);
+    if (with_gradients) {
+      auto [value, gradient] = value_and_gradient(func, x);
+      result.values(idx) = value;
+      xt::row(result.gradients, idx) = gradient;
+    } else {
+      result.values(idx) = func(x);
+    }
+  }
+  return result;
+}
+
+// As above, but the per-point fallback runs on the pool when the objective
+// is concurrent(), serially otherwise
+inline BatchResult evaluate_batch(const FObjFunc &func,
+                                  const ScalarMatrix &points,
+                                  bool with_gradients,
+                                  parallel::ThreadPool &pool) {
+  if (auto batched = dynamic_cast<const BatchEvaluation *>(&func)) {
+    return batched->evaluate_batch(points, with_gradients);
+  }
+  if (!concurrent(func)) {
+    return evaluate_batch(func, points, with_gradients);
+  }
+  const size_t npoints = points.shape(0);
+  BatchResult result;
+  result.values = xt::empty<ScalarType>({npoints});
+  if (with_gradients) {
+    result.gradients = xt::empty<ScalarType>(points.shape());
+  }
+  // Each task writes only its own row
+  pool.parallel_for(npoints, [&](size_t idx) {
+    FuncVec x = xt::row(points, idx);
+    if (with_gradients) {
+      auto [value, gradient] = value_and_gradient(func, x);
+      result.values(idx) = value;
+      xt::row(result.gradients, idx) = gradient;
+    } else {
+      result.values(idx) = concurrent_value(func, x);
+    }
+  });
+  return result;
+}
+
+} // namespace eval
+} // namespace optimize
+} // namespace xts
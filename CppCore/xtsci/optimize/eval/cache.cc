@@ -0,0 +1,188 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "xtsci/optimize/eval/cache.hpp"
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/eval/hash.hpp"
+
+namespace xts::optimize::eval {
+
+void CachedObjective::tally(EvaluationTally &counts) const {
+  ObjectiveAdaptor::tally(counts);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  counts.nfev_cached += m_value_hits;
+  counts.njev_cached += m_gradient_hits;
+}
+
+void CachedObjective::clear() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+}
+
+CachedObjective::Entry &CachedObjective::touch(const FuncVec &x) const {
+  const uint64_t key = hash_coordinates(x);
+  auto found = std::find_if(
+      m_entries.begin(), m_entries.end(), [&](const Entry &entry) {
+        return entry.hash == key && entry.x.size() == x.size() &&
+               std::memcmp(entry.x.data(), x.data(),
+                           x.size() * sizeof(ScalarType)) == 0;
+      });
+  if (found != m_entries.end()) {
+    m_entries.splice(m_entries.begin(), m_entries, found);
+    return m_entries.front();
+  }
+  if (m_entries.size() >= m_capacity && !m_entries.empty()) {
+    m_entries.pop_back();
+  }
+  m_entries.push_front(Entry{key, x, std::nullopt, std::nullopt});
+  return m_entries.front();
+}
+
+bool CachedObjective::fused_values(const FObjFunc &inner) {
+  // The potential under any other adaptors
+  const FObjFunc *potential = &inner;
+  while (auto adaptor = dynamic_cast<const ObjectiveAdaptor *>(potential)) {
+    potential = &adaptor->inner();
+  }
+  auto fused = dynamic_cast<const FusedObjective *>(potential);
+  return fused != nullptr && fused->value_costs_gradient();
+}
+
+ScalarType CachedObjective::compute(const FuncVec &x) const {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto &entry = touch(x);
+    if (entry.value) {
+      m_value_hits++;
+      return *entry.value;
+    }
+  }
+  if (m_fused_values) {
+    // Kept for a later gradient request at x
+    return value_and_gradient(x).value;
+  }
+  // Evaluate outside the lock, the potential may be slow
+  ScalarType value = inner()(x);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  touch(x).value = value;
+  return value;
+}
+
+std::optional<FuncVec>
+CachedObjective::compute_gradient(const FuncVec &x) const {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto &entry = touch(x);
+    if (entry.gradient) {
+      m_gradient_hits++;
+      return entry.gradient;
+    }
+  }
+  auto gradient = inner().gradient(x);
+  if (gradient) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    touch(x).gradient = gradient;
+  }
+  return gradient;
+}
+
+ValueGradient CachedObjective::value_and_gradient(const FuncVec &x) const {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto &entry = touch(x);
+    if (entry.value && entry.gradient) {
+      m_value_hits++;
+      m_gradient_hits++;
+      return {*entry.value, *entry.gradient};
+    }
+  }
+  auto result = eval::value_and_gradient(inner(), x);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto &entry = touch(x);
+  entry.value = result.value;
+  entry.gradient = result.gradient;
+  return result;
+}
+
+BatchResult CachedObjective::evaluate_batch(const ScalarMatrix &points,
+                                            bool with_gradients) const {
+  const size_t npoints = points.shape(0);
+  const size_t ndim = points.shape(1);
+  const size_t row_bytes = ndim * sizeof(ScalarType);
+  BatchResult result;
+  result.values = xt::empty<ScalarType>({npoints});
+  if (with_gradients) {
+    result.gradients = xt::empty<ScalarType>(points.shape());
+  }
+  // Rows which miss, as (row, position in unique), where unique holds the
+  // distinct ones, so a point repeated within the batch is evaluated once
+  std::vector<std::pair<size_t, size_t>> misses;
+  std::vector<size_t> unique;
+  std::vector<uint64_t> keys;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t idx = 0; idx < npoints; ++idx) {
+      auto &entry = touch(xt::row(points, idx));
+      if (entry.value && (!with_gradients || entry.gradient)) {
+        m_value_hits++;
+        result.values(idx) = *entry.value;
+        if (with_gradients) {
+          m_gradient_hits++;
+          xt::row(result.gradients, idx) = *entry.gradient;
+        }
+        continue;
+      }
+      const uint64_t key = hash_bytes(&points(idx, 0), row_bytes);
+      size_t pos = 0;
+      while (pos < unique.size() &&
+             !(keys[pos] == key && std::memcmp(&points(unique[pos], 0),
+                                               &points(idx, 0),
+                                               row_bytes) == 0)) {
+        ++pos;
+      }
+      if (pos == unique.size()) {
+        unique.push_back(idx);
+        keys.push_back(key);
+      } else {
+        // Served by the evaluation of the earlier row
+        m_value_hits++;
+        if (with_gradients) {
+          m_gradient_hits++;
+        }
+      }
+      misses.emplace_back(idx, pos);
+    }
+  }
+  if (misses.empty()) {
+    return result;
+  }
+  ScalarMatrix missed = xt::empty<ScalarType>({unique.size(), ndim});
+  for (size_t pos = 0; pos < unique.size(); ++pos) {
+    xt::row(missed, pos) = xt::row(points, unique[pos]);
+  }
+  // Gradients which come with the values are kept as well
+  const bool keep_gradients = with_gradients || m_fused_values;
+  auto computed = eval::evaluate_batch(inner(), missed, keep_gradients);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto &[idx, pos] : misses) {
+    result.values(idx) = computed.values(pos);
+    if (with_gradients) {
+      xt::row(result.gradients, idx) = xt::row(computed.gradients, pos);
+    }
+    if (unique[pos] != idx) {
+      continue;
+    }
+    auto &entry = touch(xt::row(points, idx));
+    entry.value = computed.values(pos);
+    if (keep_gradients) {
+      entry.gradient = FuncVec(xt::row(computed.gradients, pos));
+    }
+  }
+  return result;
+}
+
+} // namespace xts::optimize::eval
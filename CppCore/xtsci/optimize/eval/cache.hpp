@@ -0,0 +1,63 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "xtsci/optimize/eval/adaptor.hpp"
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+namespace eval {
+
+// Memoizes values and gradients of an expensive objective, keyed on the exact
+// coordinates. Line searches and get_result revisit the same points often
+// (the base point of every condition, the accepted trial point), so a handful
+// of entries is typically enough. Over a FusedObjective whose value costs
+// the gradient anyway, value misses keep the gradient too.
+class CachedObjective : public ObjectiveAdaptor {
+public:
+  explicit CachedObjective(const FObjFunc &inner, size_t capacity = 8)
+      : ObjectiveAdaptor(inner), m_capacity{capacity},
+        m_fused_values{fused_values(inner)} {}
+
+  // Stores both quantities, so a later value or gradient request is a hit
+  ValueGradient value_and_gradient(const FuncVec &x) const override;
+  // Only the rows which miss are forwarded, as a single smaller batch
+  BatchResult evaluate_batch(const ScalarMatrix &points,
+                             bool with_gradients) const override;
+  void tally(EvaluationTally &counts) const override;
+  void clear() const;
+  size_t capacity() const { return m_capacity; }
+
+protected:
+  ScalarType compute(const FuncVec &x) const override;
+  std::optional<FuncVec> compute_gradient(const FuncVec &x) const override;
+
+private:
+  struct Entry {
+    uint64_t hash;
+    FuncVec x;
+    std::optional<ScalarType> value;
+    std::optional<FuncVec> gradient;
+  };
+  size_t m_capacity;
+  // Whether a value of the inner potential costs its gradient as well
+  bool m_fused_values;
+  // Most recently used at the front
+  mutable std::list<Entry> m_entries;
+  mutable size_t m_value_hits{0}, m_gradient_hits{0};
+  mutable std::mutex m_mutex;
+
+  // Moves a matching entry to the front, or inserts a blank one there
+  Entry &touch(const FuncVec &x) const;
+  static bool fused_values(const FObjFunc &inner);
+};
+
+} // namespace eval
+} // namespace optimize
+} // namespace xts
@@ -0,0 +1,30 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+
+namespace xts {
+namespace optimize {
+namespace eval {
+
+// Names the code requesting evaluations on this thread for as long as it is
+// alive, the innermost scope wins. Tags must be string literals (or otherwise
+// outlive every ledger which may record them).
+class ScopedCallSite {
+public:
+  explicit ScopedCallSite(const char *tag) : m_previous(s_current) {
+    s_current = tag;
+  }
+  ~ScopedCallSite() { s_current = m_previous; }
+  ScopedCallSite(const ScopedCallSite &) = delete;
+  ScopedCallSite &operator=(const ScopedCallSite &) = delete;
+
+  static const char *current() { return s_current; }
+
+private:
+  const char *m_previous;
+  static inline thread_local const char *s_current = "untagged";
+};
+
+} // namespace eval
+} // namespace optimize
+} // namespace xts
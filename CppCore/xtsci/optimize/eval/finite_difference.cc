@@ -0,0 +1,65 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <algorithm>
+
+#include "xtsci/optimize/eval/batch.hpp"
+#include "xtsci/optimize/eval/finite_difference.hpp"
+
+namespace xts::optimize::eval {
+
+BatchResult
+FiniteDifferenceObjective::evaluate(const ScalarMatrix &points) const {
+  if (m_pool != nullptr) {
+    return eval::evaluate_batch(inner(), points, false, *m_pool);
+  }
+  return eval::evaluate_batch(inner(), points, false);
+}
+
+ValueGradient FiniteDifferenceObjective::differentiate(const FuncVec &x,
+                                                       bool with_value) const {
+  const size_t ndim = x.size();
+  const bool central = m_control.scheme == FDScheme::Central;
+  // Forward differences always need the center, central ones only for value
+  const size_t offset = (with_value || !central) ? 1 : 0;
+  const size_t nrows = offset + (central ? 2 * ndim : ndim);
+
+  ScalarVec steps = xt::empty<ScalarType>({ndim});
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    ScalarType step = m_control.abs_step.size() == ndim
+                          ? m_control.abs_step(idx)
+                          : m_control.rel_step *
+                                std::max<ScalarType>(1.0, std::abs(x(idx)));
+    // Use the step which is actually representable at x_i
+    volatile ScalarType shifted = x(idx) + step;
+    steps(idx) = shifted - x(idx);
+  }
+
+  ScalarMatrix points = xt::empty<ScalarType>({nrows, ndim});
+  for (size_t row = 0; row < nrows; ++row) {
+    xt::row(points, row) = x;
+  }
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    if (central) {
+      points(offset + 2 * idx, idx) += steps(idx);
+      points(offset + 2 * idx + 1, idx) -= steps(idx);
+    } else {
+      points(offset + idx, idx) += steps(idx);
+    }
+  }
+
+  auto values = evaluate(points).values;
+  FuncVec gradient = xt::empty<ScalarType>({ndim});
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    if (central) {
+      gradient(idx) =
+          (values(offset + 2 * idx) - values(offset + 2 * idx + 1)) /
+          (2 * steps(idx));
+    } else {
+      gradient(idx) = (values(offset + idx) - values(0)) / steps(idx);
+    }
+  }
+  ScalarType value = offset == 1 ? values(0) : 0.0;
+  return {value, std::move(gradient)};
+}
+
+} // namespace xts::optimize::eval
@@ -0,0 +1,64 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+#include "xtsci/optimize/eval/adaptor.hpp"
+#include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/parallel/thread_pool.hpp"
+
+namespace xts {
+namespace optimize {
+namespace eval {
+
+enum class FDScheme {
+  Forward, // n + 1 evaluations, O(h) error
+  Central  // 2n evaluations, O(h^2) error
+};
+
+struct FiniteDifferenceControl {
+  FDScheme scheme = FDScheme::Central;
+  // Step along coordinate i is rel_step * max(1, |x_i|) ...
+  ScalarType rel_step =
+      std::cbrt(std::numeric_limits<ScalarType>::epsilon());
+  // ... unless per-coordinate absolute steps are given here
+  ScalarVec abs_step;
+};
+
+// Supplies gradients for energy-only potentials by finite differences. All
+// displaced points of one gradient are evaluated as a single batch, on the
+// thread pool when one is given and the potential is eval::concurrent(),
+// e.g. a FusedObjective declaring ConcurrentEvaluation, whose value_only
+// is used then.
+class FiniteDifferenceObjective : public ObjectiveAdaptor {
+public:
+  explicit FiniteDifferenceObjective(const FObjFunc &inner,
+                                     FiniteDifferenceControl control = {})
+      : ObjectiveAdaptor(inner), m_control(control) {}
+  FiniteDifferenceObjective(const FObjFunc &inner, parallel::ThreadPool &pool,
+                            FiniteDifferenceControl control = {})
+      : ObjectiveAdaptor(inner), m_control(control), m_pool(&pool) {}
+
+  // The value comes from the same batch as the displaced points
+  ValueGradient value_and_gradient(const FuncVec &x) const override {
+    return differentiate(x, true);
+  }
+
+protected:
+  std::optional<FuncVec> compute_gradient(const FuncVec &x) const override {
+    return differentiate(x, false).gradient;
+  }
+
+private:
+  FiniteDifferenceControl m_control;
+  parallel::ThreadPool *m_pool{nullptr};
+
+  ValueGradient differentiate(const FuncVec &x, bool with_value) const;
+  BatchResult evaluate(const ScalarMatrix &points) const;
+};
+
+} // namespace eval
+} // namespace optimize
+} // namespace xts
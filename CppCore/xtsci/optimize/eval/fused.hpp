@@ -0,0 +1,107 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "xtensor-blas/xlinalg.hpp"
+
+#include "xtsci/func/base.hpp"
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+namespace eval {
+
+struct ValueGradient {
+  ScalarType value;
+  FuncVec gradient;
+};
+
+// Implemented by objectives (and adaptors) which produce the value and the
+// gradient from a single evaluation, e.g. energies and forces of a potential
+class FusedEvaluation {
+public:
+  virtual ~FusedEvaluation() = default;
+  virtual ValueGradient value_and_gradient(const FuncVec &x) const = 0;
+};
+
+// Implemented by objectives which produce phi and phi' along a ray directly,
+// without forming the gradient, e.g. by forward mode differentiation
+class DirectionalEvaluation {
+public:
+  virtual ~DirectionalEvaluation() = default;
+  virtual std::pair<ScalarType, ScalarType>
+  value_and_directional(const FuncVec &x, const FuncVec &direction) const = 0;
+};
+
+// Convenience base for potentials which only know how to do both at once,
+// those with a cheaper value alone should also override compute and
+// value_costs_gradient
+class FusedObjective : public FObjFunc, public FusedEvaluation {
+public:
+  // Whether compute() evaluates the gradient as well, so that callers who
+  // may need it later (e.g. a cache) should ask for both at once
+  virtual bool value_costs_gradient() const { return true; }
+  ValueGradient value_and_gradient(const FuncVec &x) const override {
+    m_fused_evals++;
+    return compute_value_and_gradient(x);
+  }
+  // The value alone, counted atomically unlike operator(), for calls from
+  // several threads at once
+  ScalarType value_only(const FuncVec &x) const {
+    m_value_evals++;
+    return compute(x);
+  }
+  size_t fused_evaluations() const { return m_fused_evals; }
+  // Value only calls made outside operator(), e.g. for batches
+  size_t value_evaluations() const { return m_value_evals; }
+
+protected:
+  virtual ValueGradient compute_value_and_gradient(const FuncVec &x) const = 0;
+  // For derived classes which also evaluate outside value_and_gradient
+  void count_fused(size_t nevals) const { m_fused_evals += nevals; }
+  void count_values(size_t nevals) const { m_value_evals += nevals; }
+
+  ScalarType compute(const FuncVec &x) const override {
+    return compute_value_and_gradient(x).value;
+  }
+  std::optional<FuncVec> compute_gradient(const FuncVec &x) const override {
+    return compute_value_and_gradient(x).gradient;
+  }
+
+private:
+  mutable std::atomic<size_t> m_fused_evals{0}, m_value_evals{0};
+};
+
+// Single entry point for the value and gradient at x, one potential call when
+// the objective supports it, a value and a gradient call otherwise
+inline ValueGradient value_and_gradient(const FObjFunc &func,
+                                        const FuncVec &x) {
+  if (auto fused = dynamic_cast<const FusedEvaluation *>(&func)) {
+    return fused->value_and_gradient(x);
+  }
+  auto grad_opt = func.gradient(x);
+  if (!grad_opt) {
+    throw std::runtime_error("Gradient required for fused evaluation.");
+  }
+  return {func(x), std::move(*grad_opt)};
+}
+
+// phi(alpha) and phi'(alpha) along x + alpha * direction from one evaluation
+inline std::pair<ScalarType, ScalarType>
+value_and_slope(const FObjFunc &func, const FuncVec &x,
+                const FuncVec &direction) {
+  if (auto directional = dynamic_cast<const DirectionalEvaluation *>(&func)) {
+    return directional->value_and_directional(x, direction);
+  }
+  auto [value, gradient] = value_and_gradient(func, x);
+  return {value, xt::linalg::dot(gradient, direction)()};
+}
+
+} // namespace eval
+} // namespace optimize
+} // namespace xts
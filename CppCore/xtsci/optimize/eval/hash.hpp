@@ -0,0 +1,31 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+#include <cstdint>
+
+namespace xts {
+namespace optimize {
+namespace eval {
+
+// FNV-1a over the raw bytes of a coordinate vector, so two points hash equal
+// only when they are bitwise identical
+inline uint64_t hash_bytes(const void *data, size_t nbytes) {
+  constexpr uint64_t fnv_offset = 14695981039346656037ULL;
+  constexpr uint64_t fnv_prime = 1099511628211ULL;
+  const auto *bytes = static_cast<const unsigned char *>(data);
+  uint64_t hash = fnv_offset;
+  for (size_t idx = 0; idx < nbytes; ++idx) {
+    hash ^= bytes[idx];
+    hash *= fnv_prime;
+  }
+  return hash;
+}
+
+template <typename E> uint64_t hash_coordinates(const E &x) {
+  return hash_bytes(x.data(), x.size() * sizeof(typename E::value_type));
+}
+
+} // namespace eval
+} // namespace optimize
+} // namespace xts
@@ -0,0 +1,88 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+#include "xtensor-blas/xlinalg.hpp"
+
+#include "xtsci/optimize/eval/adaptor.hpp"
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+namespace eval {
+
+// Implemented by objectives which give H(x) v without forming H(x)
+class HessianVectorProduct {
+public:
+  virtual ~HessianVectorProduct() = default;
+  virtual FuncVec hvp(const FuncVec &x, const FuncVec &v) const = 0;
+};
+
+// Forward difference of gradients, (g(x + h v) - g(x)) / h, one extra
+// gradient per product. The gradient at the last base point is kept, so
+// repeated products at the same x (e.g. inside CG) reuse it.
+class GradientDifferenceHVP : public ObjectiveAdaptor,
+                              public HessianVectorProduct {
+public:
+  explicit GradientDifferenceHVP(const FObjFunc &inner)
+      : ObjectiveAdaptor(inner) {}
+
+  // Seeds the base gradient when the caller already has it
+  void set_base(const FuncVec &x, const FuncVec &gradient) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_base_x = x;
+    m_base_gradient = gradient;
+  }
+
+  FuncVec hvp(const FuncVec &x, const FuncVec &v) const override {
+    FuncVec base_gradient = gradient_at(x);
+    ScalarType vnorm = xt::linalg::norm(v);
+    if (vnorm == 0.0) {
+      return xt::zeros_like(base_gradient);
+    }
+    // sqrt(eps) balances truncation against cancellation, scaled to x and v
+    ScalarType step =
+        std::sqrt(std::numeric_limits<ScalarType>::epsilon()) *
+        (1.0 + xt::linalg::norm(x)) / vnorm;
+    auto displaced = m_inner.get().gradient(x + step * v);
+    if (!displaced) {
+      throw std::runtime_error("Gradient required for Hessian-vector product.");
+    }
+    return (*displaced - base_gradient) / step;
+  }
+
+private:
+  mutable std::mutex m_mutex;
+  mutable FuncVec m_base_x, m_base_gradient;
+
+  FuncVec gradient_at(const FuncVec &x) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_base_x.size() != x.size() || m_base_x != x) {
+      auto grad_opt = m_inner.get().gradient(x);
+      if (!grad_opt) {
+        throw std::runtime_error(
+            "Gradient required for Hessian-vector product.");
+      }
+      m_base_x = x;
+      m_base_gradient = std::move(*grad_opt);
+    }
+    return m_base_gradient;
+  }
+};
+
+// H(x) v from the objective when it provides products, a gradient
+// difference otherwise. Never forms the dense Hessian.
+inline FuncVec hvp(const FObjFunc &func, const FuncVec &x, const FuncVec &v) {
+  if (auto provider = dynamic_cast<const HessianVectorProduct *>(&func)) {
+    return provider->hvp(x, v);
+  }
+  return GradientDifferenceHVP(func).hvp(x, v);
+}
+
+} // namespace eval
+} // namespace optimize
+} // namespace xts
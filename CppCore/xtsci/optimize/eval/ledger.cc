@@ -0,0 +1,168 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include "xtsci/optimize/eval/hash.hpp"
+#include "xtsci/optimize/eval/ledger.hpp"
+
+namespace xts::optimize::eval {
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Bit mask of the quantities a call produces
+unsigned produces(CallKind kind) {
+  switch (kind) {
+  case CallKind::Value:
+    return 1U;
+  case CallKind::Gradient:
+    return 2U;
+  case CallKind::ValueGradient:
+    return 3U;
+  case CallKind::Hessian:
+    return 4U;
+  }
+  return 0U;
+}
+} // namespace
+
+EvaluationLedger::EvaluationLedger(const FObjFunc &inner, size_t capacity)
+    : ObjectiveAdaptor(inner) {
+  m_ring.resize(std::max<size_t>(capacity, 1));
+}
+
+void EvaluationLedger::record(uint64_t hash, CallKind kind, const char *tag,
+                              double seconds) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_ring[m_total % m_ring.size()] = {hash, kind, tag, seconds};
+  m_total++;
+}
+
+ScalarType EvaluationLedger::compute(const FuncVec &x) const {
+  const char *tag = ScopedCallSite::current();
+  auto start = Clock::now();
+  ScalarType value = m_inner.get()(x);
+  record(hash_coordinates(x), CallKind::Value, tag, seconds_since(start));
+  return value;
+}
+
+std::optional<FuncVec>
+EvaluationLedger::compute_gradient(const FuncVec &x) const {
+  const char *tag = ScopedCallSite::current();
+  auto start = Clock::now();
+  auto gradient = m_inner.get().gradient(x);
+  record(hash_coordinates(x), CallKind::Gradient, tag, seconds_since(start));
+  return gradient;
+}
+
+std::optional<FuncVec>
+EvaluationLedger::compute_hessian(const FuncVec &x) const {
+  const char *tag = ScopedCallSite::current();
+  auto start = Clock::now();
+  auto hessian = m_inner.get().hessian(x);
+  record(hash_coordinates(x), CallKind::Hessian, tag, seconds_since(start));
+  return hessian;
+}
+
+ValueGradient EvaluationLedger::value_and_gradient(const FuncVec &x) const {
+  const char *tag = ScopedCallSite::current();
+  auto start = Clock::now();
+  auto result = ObjectiveAdaptor::value_and_gradient(x);
+  record(hash_coordinates(x), CallKind::ValueGradient, tag,
+         seconds_since(start));
+  return result;
+}
+
+BatchResult EvaluationLedger::evaluate_batch(const ScalarMatrix &points,
+                                             bool with_gradients) const {
+  const char *tag = ScopedCallSite::current();
+  auto start = Clock::now();
+  auto result = ObjectiveAdaptor::evaluate_batch(points, with_gradients);
+  const size_t npoints = points.shape(0);
+  const size_t ndim = points.shape(1);
+  // The batch is timed as a whole, shared evenly between its rows
+  const double seconds = seconds_since(start) / std::max<size_t>(npoints, 1);
+  const CallKind kind =
+      with_gradients ? CallKind::ValueGradient : CallKind::Value;
+  for (size_t row = 0; row < npoints; ++row) {
+    record(hash_bytes(points.data() + row * ndim, ndim * sizeof(ScalarType)),
+           kind, tag, seconds);
+  }
+  return result;
+}
+
+std::vector<LedgerRecord> EvaluationLedger::records() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const size_t capacity = m_ring.size();
+  const size_t kept = std::min(m_total, capacity);
+  std::vector<LedgerRecord> ordered;
+  ordered.reserve(kept);
+  for (size_t idx = m_total - kept; idx < m_total; ++idx) {
+    ordered.push_back(m_ring[idx % capacity]);
+  }
+  return ordered;
+}
+
+std::vector<CallSiteSummary> EvaluationLedger::summary() const {
+  std::vector<CallSiteSummary> sites;
+  std::unordered_map<uint64_t, unsigned> known; // quantities seen per point
+  for (const auto &entry : records()) {
+    auto site = std::find_if(sites.begin(), sites.end(), [&](const auto &s) {
+      return std::strcmp(s.tag, entry.tag) == 0;
+    });
+    if (site == sites.end()) {
+      sites.push_back(CallSiteSummary{entry.tag});
+      site = std::prev(sites.end());
+    }
+    site->calls++;
+    site->seconds += entry.seconds;
+    const unsigned wanted = produces(entry.kind);
+    unsigned &seen = known[entry.hash];
+    if ((seen & wanted) == wanted) {
+      site->duplicates++;
+      site->duplicate_seconds += entry.seconds;
+    }
+    seen |= wanted;
+  }
+  std::sort(sites.begin(), sites.end(), [](const auto &lhs, const auto &rhs) {
+    return lhs.duplicate_seconds > rhs.duplicate_seconds;
+  });
+  return sites;
+}
+
+void EvaluationLedger::report(std::ostream &out) const {
+  fmt::print(out, "{:>16} {:>8} {:>10} {:>12} {:>12}\n", "Call site",
+             "Calls", "Duplicate", "Time (s)", "Wasted (s)");
+  for (const auto &site : summary()) {
+    fmt::print(out, "{:>16} {:>8} {:>10} {:>12.4g} {:>12.4g}\n", site.tag,
+               site.calls, site.duplicates, site.seconds,
+               site.duplicate_seconds);
+  }
+  const size_t kept = std::min(total_calls(), m_ring.size());
+  if (kept < total_calls()) {
+    fmt::print(out, "Only the last {} of {} calls were kept\n", kept,
+               total_calls());
+  }
+}
+
+size_t EvaluationLedger::total_calls() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_total;
+}
+
+void EvaluationLedger::clear() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_total = 0;
+}
+
+} // namespace xts::optimize::eval
@@ -0,0 +1,78 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include "xtsci/optimize/eval/adaptor.hpp"
+#include "xtsci/optimize/eval/call_site.hpp"
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+namespace eval {
+
+enum class CallKind : char {
+  Value = 'f',
+  Gradient = 'g',
+  Hessian = 'h',
+  ValueGradient = 'b' // one fused call yielding both
+};
+
+struct LedgerRecord {
+  uint64_t hash; // of the coordinates, see hash.hpp
+  CallKind kind;
+  const char *tag; // ScopedCallSite active at the time of the call
+  double seconds;  // wall time spent in the wrapped objective
+};
+
+struct CallSiteSummary {
+  const char *tag;
+  size_t calls = 0;
+  // Requests for quantities already computed at the same point, within the
+  // window kept by the ledger
+  size_t duplicates = 0;
+  double seconds = 0.0;
+  double duplicate_seconds = 0.0;
+};
+
+// Records every call reaching the wrapped objective in a ring buffer which
+// is allocated once, so the most recent capacity calls are kept. Wrap it
+// directly around the potential to see what it is actually asked for.
+class EvaluationLedger : public ObjectiveAdaptor {
+public:
+  explicit EvaluationLedger(const FObjFunc &inner, size_t capacity = 4096);
+
+  ValueGradient value_and_gradient(const FuncVec &x) const override;
+  BatchResult evaluate_batch(const ScalarMatrix &points,
+                             bool with_gradients) const override;
+
+  // Oldest first
+  std::vector<LedgerRecord> records() const;
+  // Calls which fell out of the window are not included
+  std::vector<CallSiteSummary> summary() const;
+  void report(std::ostream &out) const;
+  size_t total_calls() const;
+  void clear() const;
+
+protected:
+  ScalarType compute(const FuncVec &x) const override;
+  std::optional<FuncVec> compute_gradient(const FuncVec &x) const override;
+  std::optional<FuncVec> compute_hessian(const FuncVec &x) const override;
+
+private:
+  mutable std::vector<LedgerRecord> m_ring;
+  mutable size_t m_total{0}; // m_total % capacity is the next slot
+  mutable std::mutex m_mutex;
+
+  void record(uint64_t hash, CallKind kind, const char *tag,
+              double seconds) const;
+};
+
+} // namespace eval
+} // namespace optimize
+} // namespace xts
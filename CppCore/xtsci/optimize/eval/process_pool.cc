@@ -0,0 +1,299 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "xtensor/xadapt.hpp"
+
+#include "xtsci/optimize/eval/process_pool.hpp"
+
+namespace xts::optimize::eval {
+
+namespace {
+struct Command {
+  size_t begin;
+  size_t end;
+  bool with_gradients;
+  bool stop;
+};
+
+#ifdef MSG_NOSIGNAL
+constexpr int send_flags = MSG_NOSIGNAL;
+#else
+constexpr int send_flags = 0;
+#endif
+
+// Stream sockets rather than pipes, so writing to a dead worker fails with
+// EPIPE instead of raising SIGPIPE in the parent
+bool open_channel(int fds[2]) {
+  if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    return false;
+  }
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+  int on = 1;
+  for (int idx = 0; idx < 2; ++idx) {
+    ::setsockopt(fds[idx], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+  }
+#endif
+  return true;
+}
+
+// Sockets may deliver less than asked, or be interrupted by signals
+bool read_all(int fd, void *buffer, size_t nbytes) {
+  auto *bytes = static_cast<char *>(buffer);
+  while (nbytes > 0) {
+    ssize_t got = ::read(fd, bytes, nbytes);
+    if (got < 0 && errno == EINTR) {
+      continue;
+    }
+    if (got <= 0) {
+      return false;
+    }
+    bytes += got;
+    nbytes -= static_cast<size_t>(got);
+  }
+  return true;
+}
+
+bool write_all(int fd, const void *buffer, size_t nbytes) {
+  const auto *bytes = static_cast<const char *>(buffer);
+  while (nbytes > 0) {
+    ssize_t put = ::send(fd, bytes, nbytes, send_flags);
+    if (put < 0 && errno == EINTR) {
+      continue;
+    }
+    if (put <= 0) {
+      return false;
+    }
+    bytes += put;
+    nbytes -= static_cast<size_t>(put);
+  }
+  return true;
+}
+} // namespace
+
+ProcessPoolObjective::ProcessPoolObjective(const ObjectiveFactory &factory,
+                                           size_t ndim, size_t nworkers,
+                                           size_t capacity)
+    : m_ndim{ndim},
+      m_capacity{capacity > 0 ? capacity
+                              : std::max(2 * ndim + 1, nworkers)} {
+  nworkers = std::max<size_t>(nworkers, 1);
+  m_shared_bytes = (2 * m_ndim + 1) * m_capacity * sizeof(ScalarType);
+  void *mapping = ::mmap(nullptr, m_shared_bytes, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("Could not map shared memory for the workers.");
+  }
+  m_shared = static_cast<ScalarType *>(mapping);
+
+  for (size_t idx = 0; idx < nworkers; ++idx) {
+    int command[2], status[2];
+    if (!open_channel(command)) {
+      shutdown();
+      throw std::runtime_error("Could not create channels for the workers.");
+    }
+    if (!open_channel(status)) {
+      ::close(command[0]);
+      ::close(command[1]);
+      shutdown();
+      throw std::runtime_error("Could not create channels for the workers.");
+    }
+    pid_t pid = ::fork();
+    if (pid < 0) {
+      for (int fd : {command[0], command[1], status[0], status[1]}) {
+        ::close(fd);
+      }
+      shutdown();
+      throw std::runtime_error("Could not fork a worker process.");
+    }
+    if (pid == 0) {
+      // Only our own ends stay open, so a dying parent is noticed as EOF
+      for (const auto &other : m_workers) {
+        ::close(other.command_fd);
+        ::close(other.status_fd);
+      }
+      ::close(command[1]);
+      ::close(status[0]);
+      serve(factory, command[0], status[1]);
+    }
+    ::close(command[0]);
+    ::close(status[1]);
+    m_workers.push_back({pid, command[1], status[0]});
+  }
+}
+
+ProcessPoolObjective::~ProcessPoolObjective() { shutdown(); }
+
+void ProcessPoolObjective::shutdown() {
+  Command stop{0, 0, false, true};
+  for (const auto &worker : m_workers) {
+    write_all(worker.command_fd, &stop, sizeof(stop));
+    ::close(worker.command_fd);
+    ::close(worker.status_fd);
+  }
+  for (const auto &worker : m_workers) {
+    ::waitpid(worker.pid, nullptr, 0);
+  }
+  m_workers.clear();
+  ::munmap(m_shared, m_shared_bytes);
+  m_shared = nullptr;
+}
+
+void ProcessPoolObjective::serve(const ObjectiveFactory &factory,
+                                 int command_fd, int status_fd) const {
+  std::unique_ptr<FObjFunc> func;
+  try {
+    func = factory();
+  } catch (...) {
+    // Reported on every request below
+  }
+  Command command;
+  while (read_all(command_fd, &command, sizeof(command)) && !command.stop) {
+    char failed = func ? 0 : 1;
+    for (size_t row = command.begin; row < command.end && !failed; ++row) {
+      try {
+        FuncVec x = xt::adapt(points_buffer() + row * m_ndim, m_ndim,
+                              xt::no_ownership(),
+                              std::vector<size_t>{m_ndim});
+        if (!command.with_gradients) {
+          values_buffer()[row] = (*func)(x);
+          continue;
+        }
+        auto [value, gradient] = eval::value_and_gradient(*func, x);
+        values_buffer()[row] = value;
+        std::copy(gradient.begin(), gradient.end(),
+                  gradients_buffer() + row * m_ndim);
+      } catch (...) {
+        failed = 1;
+      }
+    }
+    if (!write_all(status_fd, &failed, 1)) {
+      break;
+    }
+  }
+  // Skip static destructors and atexit handlers owned by the parent
+  ::_exit(0);
+}
+
+void ProcessPoolObjective::dispatch(size_t count,
+                                    bool with_gradients) const {
+  if (m_workers.empty()) {
+    throw std::runtime_error("No worker processes left.");
+  }
+  const size_t nactive = std::min(count, m_workers.size());
+  const size_t chunk = (count + nactive - 1) / nactive;
+  std::vector<bool> lost(m_workers.size(), false);
+  bool any_lost = false;
+  size_t nsent = 0;
+  for (size_t begin = 0; begin < count; begin += chunk, ++nsent) {
+    Command command{begin, std::min(begin + chunk, count), with_gradients,
+                    false};
+    if (!write_all(m_workers[nsent].command_fd, &command, sizeof(command))) {
+      lost[nsent] = any_lost = true;
+      break;
+    }
+  }
+  // Drain the status of every worker which got a command before reporting,
+  // a reply left unread would be taken for that of the next round
+  bool failed = false;
+  for (size_t idx = 0; idx < nsent; ++idx) {
+    char status = 1;
+    if (!read_all(m_workers[idx].status_fd, &status, 1)) {
+      lost[idx] = any_lost = true;
+    } else if (status != 0) {
+      failed = true;
+    }
+  }
+  if (any_lost) {
+    drop(lost);
+    throw std::runtime_error("Lost contact with a worker process.");
+  }
+  if (failed) {
+    throw std::runtime_error(
+        "Worker process failed to evaluate the objective.");
+  }
+}
+
+void ProcessPoolObjective::drop(const std::vector<bool> &lost) const {
+  std::vector<Worker> alive;
+  for (size_t idx = 0; idx < m_workers.size(); ++idx) {
+    const auto &worker = m_workers[idx];
+    if (!lost[idx]) {
+      alive.push_back(worker);
+      continue;
+    }
+    ::close(worker.command_fd);
+    ::close(worker.status_fd);
+    // It may only have closed its end, e.g. while stuck
+    ::kill(worker.pid, SIGKILL);
+    ::waitpid(worker.pid, nullptr, 0);
+  }
+  m_workers = std::move(alive);
+}
+
+BatchResult ProcessPoolObjective::evaluate_batch(const ScalarMatrix &points,
+                                                 bool with_gradients) const {
+  if (points.dimension() != 2 || points.shape(1) != m_ndim) {
+    throw std::runtime_error("Points do not match the process pool size.");
+  }
+  const size_t npoints = points.shape(0);
+  BatchResult result;
+  result.values = xt::empty<ScalarType>({npoints});
+  if (with_gradients) {
+    result.gradients = xt::empty<ScalarType>(points.shape());
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (size_t start = 0; start < npoints; start += m_capacity) {
+    const size_t count = std::min(m_capacity, npoints - start);
+    std::copy_n(points.data() + start * m_ndim, count * m_ndim,
+                points_buffer());
+    dispatch(count, with_gradients);
+    std::copy_n(values_buffer(), count, result.values.data() + start);
+    if (with_gradients) {
+      std::copy_n(gradients_buffer(), count * m_ndim,
+                  result.gradients.data() + start * m_ndim);
+    }
+  }
+  if (with_gradients) {
+    count_fused(npoints);
+  } else {
+    count_values(npoints);
+  }
+  return result;
+}
+
+ValueGradient
+ProcessPoolObjective::compute_value_and_gradient(const FuncVec &x) const {
+  if (x.size() != m_ndim) {
+    throw std::runtime_error("Point does not match the process pool size.");
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::copy(x.begin(), x.end(), points_buffer());
+  dispatch(1, true);
+  FuncVec gradient = xt::empty<ScalarType>(x.shape());
+  std::copy_n(gradients_buffer(), m_ndim, gradient.begin());
+  return {values_buffer()[0], std::move(gradient)};
+}
+
+ScalarType ProcessPoolObjective::compute(const FuncVec &x) const {
+  if (x.size() != m_ndim) {
+    throw std::runtime_error("Point does not match the process pool size.");
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::copy(x.begin(), x.end(), points_buffer());
+  dispatch(1, false);
+  return values_buffer()[0];
+}
+
+} // namespace xts::optimize::eval
@@ -0,0 +1,85 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "xtsci/func/base.hpp"
+#include "xtsci/optimize/eval/batch.hpp"
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+namespace eval {
+
+// Builds a fresh potential, called once inside every worker process
+using ObjectiveFactory = std::function<std::unique_ptr<FObjFunc>()>;
+
+// Evaluates a potential which is not thread safe (e.g. Fortran with global
+// state) on forked worker processes, each with its own instance. Coordinates,
+// values and gradients live in a shared anonymous mapping, sockets only carry
+// the row ranges and completion flags. Batches are split evenly across the
+// workers, single points go to the first one. A worker which dies is
+// reported once and dropped, the others carry on.
+//
+// POSIX only. Construct it before starting any threads, fork only duplicates
+// the calling thread.
+class ProcessPoolObjective : public FusedObjective, public BatchEvaluation {
+public:
+  // capacity is the number of rows exchanged per round, the default fits a
+  // central difference gradient in one round
+  ProcessPoolObjective(const ObjectiveFactory &factory, size_t ndim,
+                       size_t nworkers = std::thread::hardware_concurrency(),
+                       size_t capacity = 0);
+  ~ProcessPoolObjective();
+  ProcessPoolObjective(const ProcessPoolObjective &) = delete;
+  ProcessPoolObjective &operator=(const ProcessPoolObjective &) = delete;
+
+  BatchResult evaluate_batch(const ScalarMatrix &points,
+                             bool with_gradients) const override;
+  size_t size() const { return m_workers.size(); }
+  bool value_costs_gradient() const override { return false; }
+
+protected:
+  ValueGradient compute_value_and_gradient(const FuncVec &x) const override;
+  // Values alone, the workers skip the gradient
+  ScalarType compute(const FuncVec &x) const override;
+
+private:
+  struct Worker {
+    int pid;
+    int command_fd; // parent writes row ranges
+    int status_fd;  // parent reads completion flags
+  };
+  size_t m_ndim, m_capacity;
+  // Shrinks when workers die
+  mutable std::vector<Worker> m_workers;
+  // Shared with the workers: capacity x ndim points, capacity values,
+  // capacity x ndim gradients
+  ScalarType *m_shared{nullptr};
+  size_t m_shared_bytes{0};
+  mutable std::mutex m_mutex;
+
+  ScalarType *points_buffer() const { return m_shared; }
+  ScalarType *values_buffer() const { return m_shared + m_capacity * m_ndim; }
+  ScalarType *gradients_buffer() const {
+    return values_buffer() + m_capacity;
+  }
+  // Stops and reaps the workers, releases the mapping
+  void shutdown();
+  // Closes, kills and reaps the workers marked lost
+  void drop(const std::vector<bool> &lost) const;
+  // Evaluates the first count rows of the shared buffer
+  void dispatch(size_t count, bool with_gradients) const;
+  [[noreturn]] void serve(const ObjectiveFactory &factory, int command_fd,
+                          int status_fd) const;
+};
+
+} // namespace eval
+} // namespace optimize
+} // namespace xts
@@ -0,0 +1,247 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/parallel/thread_pool.hpp"
+
+namespace xts {
+namespace optimize {
+namespace linalg {
+
+// Vectors at least this long are split over the scoped pool, shorter ones
+// stay on the calling thread where the loops vectorize
+inline constexpr size_t kernel_threshold = size_t{1} << 18;
+
+// Lets the kernels called on this thread use pool while alive, the innermost
+// scope wins. Kernels running on the pool's own workers stay serial, so
+// nothing waits on the queue it is supposed to drain.
+class ScopedKernelPool {
+public:
+  explicit ScopedKernelPool(parallel::ThreadPool *pool,
+                            size_t threshold = kernel_threshold)
+      : m_pool(s_pool), m_threshold(s_threshold) {
+    s_pool = pool;
+    s_threshold = threshold;
+  }
+  ~ScopedKernelPool() {
+    s_pool = m_pool;
+    s_threshold = m_threshold;
+  }
+  ScopedKernelPool(const ScopedKernelPool &) = delete;
+  ScopedKernelPool &operator=(const ScopedKernelPool &) = delete;
+
+  static parallel::ThreadPool *pool() { return s_pool; }
+  static size_t threshold() { return s_threshold; }
+
+private:
+  parallel::ThreadPool *m_pool;
+  size_t m_threshold;
+  static inline thread_local parallel::ThreadPool *s_pool = nullptr;
+  static inline thread_local size_t s_threshold = kernel_threshold;
+};
+
+namespace detail {
+// Work is split in fixed blocks, and reductions add the partial sums of the
+// blocks in block order whether or not a pool runs them, so a reduction gives
+// the same bits without a pool and with any number of threads
+inline constexpr size_t kernel_block = size_t{1} << 15;
+
+inline parallel::ThreadPool *pool_for(size_t n) {
+  auto *pool = ScopedKernelPool::pool();
+  if (pool == nullptr || pool->size() < 2 ||
+      n < std::max(ScopedKernelPool::threshold(), 2 * kernel_block)) {
+    return nullptr;
+  }
+  return pool;
+}
+
+// body(begin, end) over all of [0, n)
+template <typename Body> void for_blocks(size_t n, const Body &body) {
+  auto *pool = pool_for(n);
+  if (pool == nullptr) {
+    body(size_t{0}, n);
+    return;
+  }
+  const size_t nblocks = (n + kernel_block - 1) / kernel_block;
+  pool->parallel_for(nblocks, [&body, n](size_t block) {
+    body(block * kernel_block, std::min(n, (block + 1) * kernel_block));
+  });
+}
+
+template <typename Result> void add_to(Result &total, const Result &part) {
+  if constexpr (std::is_arithmetic_v<Result>) {
+    total += part;
+  } else {
+    for (size_t idx = 0; idx < total.size(); ++idx) {
+      total[idx] += part[idx];
+    }
+  }
+}
+
+// Sum of partial(begin, end) over [0, n), Result is ScalarType or an array
+template <typename Result, typename Partial>
+Result reduce_blocks(size_t n, const Partial &partial) {
+  const size_t nblocks = std::max<size_t>(1, (n + kernel_block - 1) /
+                                                 kernel_block);
+  const auto block_sum = [&partial, n](size_t block) {
+    return partial(block * kernel_block,
+                   std::min(n, (block + 1) * kernel_block));
+  };
+  auto *pool = pool_for(n);
+  if (pool == nullptr) {
+    Result total = block_sum(0);
+    for (size_t block = 1; block < nblocks; ++block) {
+      add_to(total, block_sum(block));
+    }
+    return total;
+  }
+  std::vector<Result> sums(nblocks);
+  pool->parallel_for(nblocks,
+                     [&](size_t block) { sums[block] = block_sum(block); });
+  Result total = sums[0];
+  for (size_t block = 1; block < nblocks; ++block) {
+    add_to(total, sums[block]);
+  }
+  return total;
+}
+
+// Four independent sums let the compiler vectorize without reassociating.
+// Operands narrower than ScalarType are widened before multiplying.
+template <typename X, typename Y>
+ScalarType dot_range(const X *x, const Y *y, size_t begin, size_t end) {
+  ScalarType acc[4] = {0.0, 0.0, 0.0, 0.0};
+  size_t idx = begin;
+  for (; idx + 4 <= end; idx += 4) {
+    for (size_t lane = 0; lane < 4; ++lane) {
+      acc[lane] += static_cast<ScalarType>(x[idx + lane]) *
+                   static_cast<ScalarType>(y[idx + lane]);
+    }
+  }
+  for (; idx < end; ++idx) {
+    acc[0] +=
+        static_cast<ScalarType>(x[idx]) * static_cast<ScalarType>(y[idx]);
+  }
+  return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+inline void check_sizes(size_t lhs, size_t rhs) {
+  if (lhs != rhs) {
+    throw std::runtime_error("Vector sizes do not match.");
+  }
+}
+} // namespace detail
+
+// BLAS-1 kernels on contiguous storage, the pointer forms allow mixed
+// precision operands as in the reduced precision histories
+
+// x . y
+template <typename X, typename Y>
+ScalarType dot(const X *x, const Y *y, size_t n) {
+  return detail::reduce_blocks<ScalarType>(
+      n, [x, y](size_t begin, size_t end) {
+        return detail::dot_range(x, y, begin, end);
+      });
+}
+
+// y <- a x + y
+template <typename X>
+void axpy(ScalarType a, const X *x, ScalarType *y, size_t n) {
+  detail::for_blocks(n, [a, x, y](size_t begin, size_t end) {
+    for (size_t idx = begin; idx < end; ++idx) {
+      y[idx] += a * static_cast<ScalarType>(x[idx]);
+    }
+  });
+}
+
+// y <- a x + b y, y is not read for b = 0 (as in BLAS) so it may start out
+// as anything
+template <typename X>
+void axpby(ScalarType a, const X *x, ScalarType b, ScalarType *y, size_t n) {
+  detail::for_blocks(n, [a, x, b, y](size_t begin, size_t end) {
+    if (b == 0.0) {
+      for (size_t idx = begin; idx < end; ++idx) {
+        y[idx] = a * static_cast<ScalarType>(x[idx]);
+      }
+      return;
+    }
+    for (size_t idx = begin; idx < end; ++idx) {
+      y[idx] = a * static_cast<ScalarType>(x[idx]) + b * y[idx];
+    }
+  });
+}
+
+// y <- x
+template <typename X> void copy(const X *x, ScalarType *y, size_t n) {
+  detail::for_blocks(n, [x, y](size_t begin, size_t end) {
+    std::copy(x + begin, x + end, y + begin);
+  });
+}
+
+// x <- a x
+inline void scal(ScalarType a, ScalarType *x, size_t n) {
+  detail::for_blocks(n, [a, x](size_t begin, size_t end) {
+    for (size_t idx = begin; idx < end; ++idx) {
+      x[idx] *= a;
+    }
+  });
+}
+
+// The same on contiguous containers (ScalarVec, FuncVec), not on views or
+// expressions. Operands of different sizes throw.
+
+template <typename X, typename Y> ScalarType dot(const X &x, const Y &y) {
+  detail::check_sizes(x.size(), y.size());
+  return dot(x.data(), y.data(), x.size());
+}
+
+// Unscaled, fine for gradients and steps, not for values near overflow
+template <typename X> ScalarType nrm2(const X &x) {
+  return std::sqrt(dot(x.data(), x.data(), x.size()));
+}
+
+template <typename X, typename Y> void axpy(ScalarType a, const X &x, Y &y) {
+  detail::check_sizes(x.size(), y.size());
+  axpy(a, x.data(), y.data(), y.size());
+}
+
+template <typename X, typename Y>
+void axpby(ScalarType a, const X &x, ScalarType b, Y &y) {
+  detail::check_sizes(x.size(), y.size());
+  axpby(a, x.data(), b, y.data(), y.size());
+}
+
+// Into storage of the same size, never reallocates
+template <typename X, typename Y> void copy(const X &x, Y &y) {
+  detail::check_sizes(x.size(), y.size());
+  copy(x.data(), y.data(), y.size());
+}
+
+template <typename X> void scal(ScalarType a, X &x) {
+  scal(a, x.data(), x.size());
+}
+
+// x . y for every y in ys in one sweep, blocks of x stay in cache across
+// the products, e.g.
+// auto [gg, gp] = linalg::multi_dot(g, g, g_prev);
+template <typename X, typename... Ys>
+std::array<ScalarType, sizeof...(Ys)> multi_dot(const X &x, const Ys &...ys) {
+  using Result = std::array<ScalarType, sizeof...(Ys)>;
+  (detail::check_sizes(x.size(), ys.size()), ...);
+  const auto *xdata = x.data();
+  return detail::reduce_blocks<Result>(
+      x.size(), [xdata, &ys...](size_t begin, size_t end) {
+        return Result{detail::dot_range(xdata, ys.data(), begin, end)...};
+      });
+}
+
+} // namespace linalg
+} // namespace optimize
+} // namespace xts
@@ -0,0 +1,262 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "xtensor/xbuilder.hpp"
+
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/linalg/ldlt.hpp"
+
+namespace xts::optimize::linalg {
+
+void LDLT::reset(size_t ndim, ScalarType diag) {
+  m_u = xt::eye<ScalarType>(ndim);
+  m_d = xt::empty<ScalarType>({ndim});
+  m_d.fill(diag);
+  m_z = xt::zeros<ScalarType>({ndim});
+  m_w = xt::zeros<ScalarType>({ndim});
+  m_pivots = xt::zeros<ScalarType>({ndim});
+  m_saved_u = m_u;
+  m_saved_d = m_d;
+}
+
+void LDLT::restore(const ScalarMatrix &unit_upper, const ScalarVec &diagonal) {
+  const size_t ndim = diagonal.size();
+  if (unit_upper.shape(0) != ndim || unit_upper.shape(1) != ndim) {
+    throw std::runtime_error("LDL^T factors do not match in size.");
+  }
+  reset(ndim);
+  for (size_t row = 0; row < ndim; ++row) {
+    if (diagonal(row) == 0.0) {
+      throw std::runtime_error("LDL^T factors have a zero pivot.");
+    }
+    m_d(row) = diagonal(row);
+    for (size_t col = row + 1; col < ndim; ++col) {
+      m_u(row, col) = unit_upper(row, col);
+    }
+  }
+}
+
+ScalarType LDLT::modified_cholesky(const ScalarMatrix &hess) {
+  const size_t ndim = hess.shape(0);
+  if (hess.shape(1) != ndim) {
+    throw std::runtime_error("Only a square matrix has a Cholesky factor.");
+  }
+  if (m_d.size() != ndim) {
+    reset(ndim);
+  }
+  // beta bounds the elements of L sqrt(D) [GMW 4.4.2.2], delta the pivots
+  const ScalarType eps = std::numeric_limits<ScalarType>::epsilon();
+  ScalarType diag = 0.0, offdiag = 0.0;
+  for (size_t row = 0; row < ndim; ++row) {
+    diag = std::max(diag, std::abs(hess(row, row)));
+    for (size_t col = row + 1; col < ndim; ++col) {
+      offdiag = std::max(offdiag, std::abs(hess(row, col)));
+    }
+  }
+  const ScalarType nu =
+      std::max(ScalarType{1}, std::sqrt(ScalarType(ndim * ndim) - 1.0));
+  const ScalarType beta_sq = std::max({diag, offdiag / nu, eps});
+  const ScalarType delta = eps * std::max(diag + offdiag, ScalarType{1});
+  ScalarType added = 0.0;
+  // Row j of U = L^T from row j of hess less the earlier rows of U
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    ScalarType *row = m_u.data() + idx * ndim;
+    for (size_t col = idx; col < ndim; ++col) {
+      row[col] = hess(idx, col);
+    }
+    for (size_t prev = 0; prev < idx; ++prev) {
+      const ScalarType *above = m_u.data() + prev * ndim;
+      axpy(-m_d(prev) * above[idx], above + idx, row + idx, ndim - idx);
+    }
+    ScalarType largest = 0.0;
+    for (size_t col = idx + 1; col < ndim; ++col) {
+      largest = std::max(largest, std::abs(row[col]));
+    }
+    const ScalarType pivot = std::max(
+        {std::abs(row[idx]), largest * largest / beta_sq, delta});
+    added = std::max(added, pivot - row[idx]);
+    m_d(idx) = pivot;
+    row[idx] = 1.0;
+    scal(1.0 / pivot, row + idx + 1, ndim - idx - 1);
+  }
+  return added;
+}
+
+bool LDLT::factor(const ScalarMatrix &mat) {
+  const size_t ndim = mat.shape(0);
+  if (mat.shape(1) != ndim) {
+    throw std::runtime_error("Only a square matrix has an LDL^T factor.");
+  }
+  if (m_d.size() != ndim) {
+    reset(ndim);
+  }
+  ScalarType largest = 0.0;
+  for (auto val : mat) {
+    largest = std::max(largest, std::abs(val));
+  }
+  const ScalarType tiny =
+      ndim * std::numeric_limits<ScalarType>::epsilon() * largest;
+  // As modified_cholesky, with the pivots left as they come
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    ScalarType *row = m_u.data() + idx * ndim;
+    for (size_t col = idx; col < ndim; ++col) {
+      row[col] = mat(idx, col);
+    }
+    for (size_t prev = 0; prev < idx; ++prev) {
+      const ScalarType *above = m_u.data() + prev * ndim;
+      axpy(-m_d(prev) * above[idx], above + idx, row + idx, ndim - idx);
+    }
+    const ScalarType pivot = row[idx];
+    if (!(std::abs(pivot) > tiny)) {
+      return false;
+    }
+    m_d(idx) = pivot;
+    row[idx] = 1.0;
+    scal(1.0 / pivot, row + idx + 1, ndim - idx - 1);
+  }
+  return true;
+}
+
+bool LDLT::pivots_after(ScalarType alpha, const ScalarVec &z) {
+  // C1 eliminates z against L column by column, so the multipliers it meets
+  // are L^-1 z and the pivots follow without touching the factors
+  static const ScalarType cancel =
+      std::sqrt(std::numeric_limits<ScalarType>::epsilon());
+  copy(z, m_z);
+  forward(m_z);
+  for (size_t idx = 0; idx < m_d.size(); ++idx) {
+    const ScalarType added = alpha * m_z(idx) * m_z(idx);
+    const ScalarType pivot = m_d(idx) + added;
+    if (!(std::abs(pivot) > cancel * (std::abs(m_d(idx)) + std::abs(added)))) {
+      return false;
+    }
+    m_pivots(idx) = pivot;
+    alpha *= m_d(idx) / pivot;
+  }
+  return true;
+}
+
+bool LDLT::rank_one_update(ScalarType alpha, const ScalarVec &z) {
+  if (!pivots_after(alpha, z)) {
+    return false;
+  }
+  const size_t ndim = m_d.size();
+  copy(z, m_z);
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    const ScalarType mult = m_z(idx);
+    const ScalarType pivot = m_pivots(idx);
+    const ScalarType beta = mult * alpha / pivot;
+    alpha *= m_d(idx) / pivot;
+    m_d(idx) = pivot;
+    ScalarType *row = m_u.data() + idx * ndim + idx + 1;
+    ScalarType *rest = m_z.data() + idx + 1;
+    const size_t len = ndim - idx - 1;
+    axpy(-mult, row, rest, len);
+    axpy(beta, rest, row, len);
+  }
+  return true;
+}
+
+bool LDLT::rank_two_update(ScalarType alpha, const ScalarVec &u,
+                           const ScalarVec &v) {
+  // alpha (u v^T + v u^T) = |alpha| / 2 (a a^T - b b^T), a = u + sign v and
+  // b = u - sign v, adding before removing keeps the pivots away from zero
+  const ScalarType sign = alpha > 0.0 ? 1.0 : -1.0;
+  const ScalarType half = 0.5 * std::abs(alpha);
+  copy(u, m_w);
+  axpy(sign, v, m_w);
+  copy(m_u, m_saved_u);
+  copy(m_d, m_saved_d);
+  if (!rank_one_update(half, m_w)) {
+    return false;
+  }
+  copy(u, m_w);
+  axpy(-sign, v, m_w);
+  if (!rank_one_update(-half, m_w)) {
+    copy(m_saved_u, m_u);
+    copy(m_saved_d, m_d);
+    return false;
+  }
+  return true;
+}
+
+void LDLT::forward(ScalarVec &v) const {
+  const size_t ndim = m_d.size();
+  for (size_t idx = 0; idx + 1 < ndim; ++idx) {
+    axpy(-v(idx), m_u.data() + idx * ndim + idx + 1, v.data() + idx + 1,
+         ndim - idx - 1);
+  }
+}
+
+void LDLT::backward(ScalarVec &v) const {
+  const size_t ndim = m_d.size();
+  for (size_t idx = ndim; idx-- > 0;) {
+    v(idx) -= dot(m_u.data() + idx * ndim + idx + 1, v.data() + idx + 1,
+                  ndim - idx - 1);
+  }
+}
+
+void LDLT::multiply(ScalarVec &v) const {
+  // U v, D, then U^T, each in place by the order of the rows
+  const size_t ndim = m_d.size();
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    v(idx) += dot(m_u.data() + idx * ndim + idx + 1, v.data() + idx + 1,
+                  ndim - idx - 1);
+    v(idx) *= m_d(idx);
+  }
+  for (size_t idx = ndim; idx-- > 0;) {
+    axpy(v(idx), m_u.data() + idx * ndim + idx + 1, v.data() + idx + 1,
+         ndim - idx - 1);
+  }
+}
+
+bool LDLT::solve(ScalarVec &v) const {
+  if (std::find(m_d.begin(), m_d.end(), 0.0) != m_d.end()) {
+    return false;
+  }
+  forward(v);
+  for (size_t idx = 0; idx < m_d.size(); ++idx) {
+    v(idx) /= m_d(idx);
+  }
+  backward(v);
+  return true;
+}
+
+void LDLT::solve_definite(ScalarVec &v, ScalarType floor) const {
+  ScalarType largest = 0.0;
+  for (auto pivot : m_d) {
+    largest = std::max(largest, std::abs(pivot));
+  }
+  forward(v);
+  for (size_t idx = 0; idx < m_d.size(); ++idx) {
+    v(idx) /= std::max(std::abs(m_d(idx)), floor * largest);
+  }
+  backward(v);
+}
+
+size_t LDLT::negative_pivots() const {
+  return std::count_if(m_d.begin(), m_d.end(),
+                       [](ScalarType pivot) { return pivot < 0.0; });
+}
+
+ScalarMatrix LDLT::todense() const {
+  const size_t ndim = m_d.size();
+  ScalarMatrix dense = xt::zeros<ScalarType>({ndim, ndim});
+  // sum_k d_k u_k u_k^T over the rows u_k of U, with a unit diagonal
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    for (size_t row = idx; row < ndim; ++row) {
+      const ScalarType left = row == idx ? 1.0 : m_u(idx, row);
+      for (size_t col = idx; col < ndim; ++col) {
+        const ScalarType right = col == idx ? 1.0 : m_u(idx, col);
+        dense(row, col) += m_d(idx) * left * right;
+      }
+    }
+  }
+  return dense;
+}
+
+} // namespace xts::optimize::linalg
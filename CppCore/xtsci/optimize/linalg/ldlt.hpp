@@ -0,0 +1,109 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+#include <utility>
+
+#include "xtensor/xtensor.hpp"
+
+#include "xtsci/optimize/linalg/linear_operator.hpp"
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+namespace linalg {
+
+// A symmetric, possibly indefinite, B = L D L^T kept as its factors and
+// changed by O(n^2) rank one and rank two updates [GGMS method C1], so
+// B^-1 v costs two triangular solves. L is held transposed, as a unit upper
+// triangle U row major, which keeps every inner loop contiguous.
+//
+// An update is refused, leaving the factors as they were, when a pivot of
+// the result would be lost to cancellation; with an indefinite D this is
+// how C1 breaks down.
+//
+// References:
+// [GGMS] Gill, P. E., Golub, G. H., Murray, W., & Saunders, M. A. (1974).
+// Methods for modifying matrix factorizations. Mathematics of Computation,
+// 28(126), 505-535.
+// [GMW] Gill, P. E., Murray, W., & Wright, M. H. (1981). Practical
+// optimization. Academic Press.
+// [NW] Nocedal, J., & Wright, S. J. (2006). Numerical optimization (2nd ed).
+// Springer.
+// [V] Vanderbei, R. J. (1995). Symmetric quasidefinite matrices. SIAM
+// Journal on Optimization, 5(1), 100-113.
+class LDLT {
+public:
+  LDLT() = default;
+  explicit LDLT(size_t ndim, ScalarType diag = 1.0) { reset(ndim, diag); }
+
+  // B = diag I
+  void reset(size_t ndim, ScalarType diag = 1.0);
+  // Factors hess + E with E >= 0 diagonal, as small as keeps every pivot
+  // positive and L bounded [GMW 4.4.2.2], so L D L^T is positive definite
+  // and E = 0 for a safely positive definite hess. Returns max E_jj.
+  ScalarType modified_cholesky(const ScalarMatrix &hess);
+  // Factors mat as it is, without pivoting, which suits quasi-definite
+  // matrices [-E A^T; A F] with E and F positive definite: every symmetric
+  // ordering of those has an LDL^T factorization [V]. False when a pivot is
+  // lost to rounding, the factors are then of no use.
+  bool factor(const ScalarMatrix &mat);
+  // Takes U (only the strict upper triangle is read) and D, e.g. from a
+  // checkpoint
+  void restore(const ScalarMatrix &unit_upper, const ScalarVec &diagonal);
+
+  // B <- B + alpha z z^T
+  bool rank_one_update(ScalarType alpha, const ScalarVec &z);
+  // B <- B + alpha (u v^T + v u^T), as two rank one updates
+  bool rank_two_update(ScalarType alpha, const ScalarVec &u,
+                       const ScalarVec &v);
+
+  // v <- B v
+  void multiply(ScalarVec &v) const;
+  // v <- B^-1 v, false when a pivot is zero
+  bool solve(ScalarVec &v) const;
+  // v <- (L |D| L^T)^-1 v with |D| kept above floor times its largest entry,
+  // which is positive definite, so -solve_definite(g) is a descent direction
+  // whatever the inertia of B [NW 3.4]
+  void solve_definite(ScalarVec &v, ScalarType floor = 1e-8) const;
+
+  size_t size() const { return m_d.size(); }
+  const ScalarMatrix &unit_upper() const { return m_u; }
+  const ScalarVec &diagonal() const { return m_d; }
+  // Number of negative pivots, which by Sylvester's law is that of B
+  size_t negative_pivots() const;
+  ScalarMatrix todense() const;
+
+private:
+  ScalarMatrix m_u;
+  ScalarVec m_d;
+  // Scratch for the updates, sized by reset
+  ScalarVec m_z, m_w, m_pivots;
+  ScalarMatrix m_saved_u;
+  ScalarVec m_saved_d;
+
+  // Pivots C1 would produce, false if one of them cancels
+  bool pivots_after(ScalarType alpha, const ScalarVec &z);
+  void forward(ScalarVec &v) const;  // v <- L^-1 v
+  void backward(ScalarVec &v) const; // v <- L^-T v
+};
+
+// B^-1 through a copy of the factors
+class LDLTInverseOperator : public LinearOperator {
+public:
+  explicit LDLTInverseOperator(LDLT factors) : m_factors(std::move(factors)) {}
+
+  size_t size() const override { return m_factors.size(); }
+  ScalarVec matvec(const ScalarVec &v) const override {
+    ScalarVec result = v;
+    m_factors.solve(result);
+    return result;
+  }
+
+private:
+  LDLT m_factors;
+};
+
+} // namespace linalg
+} // namespace optimize
+} // namespace xts
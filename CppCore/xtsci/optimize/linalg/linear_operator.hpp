@@ -0,0 +1,56 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+#include <utility>
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+namespace linalg {
+
+// A square matrix known only through its action on vectors, e.g. a limited
+// memory inverse Hessian. todense() is there for small problems and tests,
+// it costs n products.
+class LinearOperator {
+public:
+  virtual ~LinearOperator() = default;
+  virtual size_t size() const = 0;
+  virtual ScalarVec matvec(const ScalarVec &v) const = 0;
+
+  virtual ScalarMatrix todense() const {
+    const size_t ndim = size();
+    ScalarMatrix dense = xt::empty<ScalarType>({ndim, ndim});
+    ScalarVec unit = xt::zeros<ScalarType>({ndim});
+    for (size_t col = 0; col < ndim; ++col) {
+      unit(col) = 1.0;
+      xt::col(dense, col) = matvec(unit);
+      unit(col) = 0.0;
+    }
+    return dense;
+  }
+};
+
+// An operator around a matrix which already exists
+class DenseOperator : public LinearOperator {
+public:
+  explicit DenseOperator(ScalarMatrix matrix) : m_matrix(std::move(matrix)) {}
+
+  size_t size() const override { return m_matrix.shape(0); }
+  ScalarVec matvec(const ScalarVec &v) const override {
+    return xt::linalg::dot(m_matrix, v);
+  }
+  ScalarMatrix todense() const override { return m_matrix; }
+
+private:
+  ScalarMatrix m_matrix;
+};
+
+} // namespace linalg
+} // namespace optimize
+} // namespace xts
@@ -0,0 +1,88 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <stdexcept>
+
+#include "xtensor/xbuilder.hpp"
+
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/linalg/symmetric.hpp"
+
+namespace xts::optimize::linalg {
+
+void SymmetricMatrix::resize(size_t ndim) {
+  m_ndim = ndim;
+  const size_t nvals = m_storage == SymmetricStorage::full
+                           ? ndim * ndim
+                           : ndim * (ndim + 1) / 2;
+  m_data = xt::zeros<ScalarType>({nvals});
+}
+
+void SymmetricMatrix::set_identity(ScalarType scale) {
+  m_data.fill(0.0);
+  for (size_t idx = 0; idx < m_ndim; ++idx) {
+    m_data(index(idx, idx)) = scale;
+  }
+}
+
+void SymmetricMatrix::assign(const ScalarMatrix &dense) {
+  if (dense.shape(0) != dense.shape(1)) {
+    throw std::runtime_error("A symmetric matrix must be square.");
+  }
+  if (dense.shape(0) != m_ndim) {
+    resize(dense.shape(0));
+  }
+  for (size_t row = 0; row < m_ndim; ++row) {
+    const size_t first = m_storage == SymmetricStorage::full ? 0 : row;
+    for (size_t col = first; col < m_ndim; ++col) {
+      m_data(index(row, col)) = 0.5 * (dense(row, col) + dense(col, row));
+    }
+  }
+}
+
+ScalarMatrix SymmetricMatrix::todense() const {
+  ScalarMatrix dense = xt::empty<ScalarType>({m_ndim, m_ndim});
+  for (size_t row = 0; row < m_ndim; ++row) {
+    for (size_t col = 0; col < m_ndim; ++col) {
+      dense(row, col) = (*this)(row, col);
+    }
+  }
+  return dense;
+}
+
+void SymmetricMatrix::symv(ScalarType alpha, const ScalarType *x,
+                           ScalarType *y) const {
+  const ScalarType *data = m_data.data();
+  if (m_storage == SymmetricStorage::full) {
+    for (size_t row = 0; row < m_ndim; ++row) {
+      y[row] = alpha * dot(data + row_start(row), x, m_ndim);
+    }
+    return;
+  }
+  // Row i of the upper triangle gives its own entry of A x by a dot and,
+  // through the mirrored column, adds x_i times itself to the ones after it
+  for (size_t row = 0; row < m_ndim; ++row) {
+    y[row] = 0.0;
+  }
+  for (size_t row = 0; row < m_ndim; ++row) {
+    const ScalarType *upper = data + row_start(row) + row;
+    const size_t len = m_ndim - row;
+    y[row] += alpha * dot(upper, x + row, len);
+    axpy(alpha * x[row], upper + 1, y + row + 1, len - 1);
+  }
+}
+
+void SymmetricMatrix::syr2(ScalarType alpha, const ScalarType *x,
+                           const ScalarType *y) {
+  // Row i gains alpha (x_i y + y_i x), over the whole row when full and from
+  // the diagonal on when packed
+  ScalarType *data = m_data.data();
+  for (size_t row = 0; row < m_ndim; ++row) {
+    const size_t first = m_storage == SymmetricStorage::full ? 0 : row;
+    ScalarType *dest = data + row_start(row) + first;
+    const size_t len = m_ndim - first;
+    axpy(alpha * x[row], y + first, dest, len);
+    axpy(alpha * y[row], x + first, dest, len);
+  }
+}
+
+} // namespace xts::optimize::linalg
@@ -0,0 +1,80 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+
+#include "xtensor/xtensor.hpp"
+
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+namespace linalg {
+
+// full keeps all n^2 values row major, packed only the upper triangle row by
+// row in n (n + 1) / 2, as LAPACK's 'U' packed format transposed
+enum class SymmetricStorage { full, packed };
+
+// A symmetric matrix touched only through SYMV and SYR2 style kernels, so
+// updates and products cost O(n^2) with no n x n temporaries
+class SymmetricMatrix {
+public:
+  SymmetricMatrix() = default;
+  explicit SymmetricMatrix(size_t ndim,
+                           SymmetricStorage storage = SymmetricStorage::full)
+      : m_storage(storage) {
+    resize(ndim);
+  }
+
+  // Zeroed, keeping the storage scheme
+  void resize(size_t ndim);
+  // scale I
+  void set_identity(ScalarType scale = 1.0);
+  // Takes the mean of dense and its transpose, dense sets the size
+  void assign(const ScalarMatrix &dense);
+  ScalarMatrix todense() const;
+
+  size_t size() const { return m_ndim; }
+  SymmetricStorage storage() const { return m_storage; }
+  // Number of values held, n^2 or n (n + 1) / 2
+  size_t stored() const { return m_data.size(); }
+  ScalarType operator()(size_t row, size_t col) const {
+    return m_data(index(row, col));
+  }
+
+  // y <- alpha A x
+  void symv(ScalarType alpha, const ScalarType *x, ScalarType *y) const;
+  // A <- A + alpha (x y^T + y x^T)
+  void syr2(ScalarType alpha, const ScalarType *x, const ScalarType *y);
+
+  template <typename X, typename Y>
+  void symv(ScalarType alpha, const X &x, Y &y) const {
+    symv(alpha, x.data(), y.data());
+  }
+  template <typename X, typename Y>
+  void syr2(ScalarType alpha, const X &x, const Y &y) {
+    syr2(alpha, x.data(), y.data());
+  }
+
+private:
+  SymmetricStorage m_storage{SymmetricStorage::full};
+  size_t m_ndim{0};
+  ScalarVec m_data;
+
+  // Start of the stored part of row, which begins at the diagonal if packed
+  size_t row_start(size_t row) const {
+    return m_storage == SymmetricStorage::full
+               ? row * m_ndim
+               : row * m_ndim - row * (row - 1) / 2 - row;
+  }
+  size_t index(size_t row, size_t col) const {
+    if (m_storage == SymmetricStorage::full) {
+      return row * m_ndim + col;
+    }
+    return row <= col ? row_start(row) + col : row_start(col) + row;
+  }
+};
+
+} // namespace linalg
+} // namespace optimize
+} // namespace xts
@@ -22,12 +22,10 @@ public:
   ScalarType c;
   explicit ArmijoCondition(ScalarType c_val = 0.0001) : c(c_val) {}
 
-  bool operator()(ScalarType alpha, const FObjFunc &func,
-                  const SearchState &cstate) const override {
-    auto [x, direction] = cstate;
-    ScalarType lhs = func(x + alpha * direction);
-    ScalarType rhs =
-        func(x) + c * alpha * func.directional_derivative(x, direction);
+  bool check(ScalarType alpha, LineProbe &probe) const override {
+    eval::ScopedCallSite site("armijo");
+    ScalarType lhs = probe.phi(alpha);
+    ScalarType rhs = probe.phi_0() + c * alpha * probe.phi_prime_0();
     return lhs <= rhs;
   }
 };
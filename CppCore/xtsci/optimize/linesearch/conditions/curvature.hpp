@@ -22,12 +22,10 @@ public:
   ScalarType c_prime;
   explicit CurvatureCondition(ScalarType c_prime_val = 0.9)
       : c_prime(c_prime_val) {}
-  bool operator()(ScalarType alpha, const FObjFunc &func,
-                  const SearchState &cstate) const override {
-    auto [x, direction] = cstate;
-    auto lhs =
-        xt::linalg::dot(*func.gradient(x + alpha * direction), direction)();
-    auto rhs = c_prime * xt::linalg::dot(*func.gradient(x), direction)();
+  bool needs_slope() const override { return true; }
+  bool check(ScalarType alpha, LineProbe &probe) const override {
+    auto lhs = probe.phi_prime(alpha);
+    auto rhs = c_prime * probe.phi_prime_0();
     return lhs >= rhs;
   };
 };
@@ -36,13 +34,11 @@ class StrongCurvatureCondition : public SearchCondition {
 public:
   ScalarType c;
   explicit StrongCurvatureCondition(ScalarType c_val = 0.9) : c(c_val) {}
+  bool needs_slope() const override { return true; }
 
-  bool operator()(ScalarType alpha, const FObjFunc &func,
-                  const SearchState &cstate) const override {
-    auto [x, direction] = cstate;
-    auto grad_phi_alpha =
-        xt::linalg::dot(*func.gradient(x + alpha * direction), direction)();
-    auto grad_phi_0 = func.directional_derivative(x, direction);
+  bool check(ScalarType alpha, LineProbe &probe) const override {
+    auto grad_phi_alpha = probe.phi_prime(alpha);
+    auto grad_phi_0 = probe.phi_prime_0();
     return std::abs(grad_phi_alpha) <= c * std::abs(grad_phi_0);
   }
 };
@@ -30,13 +30,10 @@ public:
     }
   }
 
-  bool operator()(ScalarType alpha, const FObjFunc &func,
-                  const SearchState &cstate) const override {
-    auto [x, direction] = cstate;
-    ScalarType lhs = func(x + alpha * direction);
-    ScalarType f_at_x = func(x);
-    ScalarType gradient_dot_dir =
-        xt::linalg::dot(*func.gradient(x), direction)();
+  bool check(ScalarType alpha, LineProbe &probe) const override {
+    ScalarType lhs = probe.phi(alpha);
+    ScalarType f_at_x = probe.phi_0();
+    ScalarType gradient_dot_dir = probe.phi_prime_0();
 
     ScalarType upper_bound = f_at_x + (1 - c1) * alpha * gradient_dot_dir;
 
@@ -53,9 +50,9 @@ public:
                               ScalarType c_upper = 1e-4)
       : armijo(c_armijo), goldstein_upper(c_upper) {}
 
-  bool operator()(ScalarType alpha, const FObjFunc &func,
-                  const SearchState &cstate) const override {
-    return armijo(alpha, func, cstate) && goldstein_upper(alpha, func, cstate);
+  bool check(ScalarType alpha, LineProbe &probe) const override {
+    // Both bounds are tested against the same evaluation of the trial point
+    return armijo(alpha, probe) && goldstein_upper(alpha, probe);
   }
 };
 
@@ -28,10 +28,11 @@ public:
   explicit WeakWolfeCondition(ScalarType c_armijo = 1e-4,
                               ScalarType c_curvature = 0.9)
       : armijo(c_armijo), curvature(c_curvature) {}
+  bool needs_slope() const override { return true; }
 
-  bool operator()(ScalarType alpha, const FObjFunc &func,
-                  const SearchState &cstate) const override {
-    return armijo(alpha, func, cstate) && curvature(alpha, func, cstate);
+  bool check(ScalarType alpha, LineProbe &probe) const override {
+    // Both conditions share one evaluation of the trial point
+    return armijo(alpha, probe) && curvature(alpha, probe);
   }
 };
 
@@ -43,10 +44,11 @@ public:
   explicit StrongWolfeCondition(ScalarType c_armijo = 1e-4,
                                 ScalarType c_curvature = 0.9)
       : armijo(c_armijo), curvature(c_curvature) {}
+  bool needs_slope() const override { return true; }
 
-  bool operator()(ScalarType alpha, const FObjFunc &func,
-                  const SearchState &cstate) const override {
-    return armijo(alpha, func, cstate) && curvature(alpha, func, cstate);
+  bool check(ScalarType alpha, LineProbe &probe) const override {
+    // Both conditions share one evaluation of the trial point
+    return armijo(alpha, probe) && curvature(alpha, probe);
   }
 };
 
@@ -25,15 +25,36 @@ public:
       : SearchStrategy(optim), m_cond(cond),
         m_geom{step_size::GeometricReductionStepSize(geom_beta)} {}
 
-  ScalarType search(const AlphaState _in, const FObjFunc &func,
-                    const SearchState &cstate) override {
+protected:
+  bool slopes() const override { return m_cond.get().needs_slope(); }
+
+  LineProbe::Point run(const AlphaState _in, LineProbe &probe) override {
+    eval::ScopedCallSite site("backtracking");
     auto in_alpha = _in;
     ScalarType alpha = _in.init;
-    while (alpha > 0 && !m_cond(alpha, func, cstate)) {
-      alpha = m_geom.nextStep(in_alpha, func, cstate);
+    while (alpha > 0) {
+      if (m_pool != nullptr && m_speculation > 0) {
+        speculate(in_alpha, probe);
+      }
+      if (m_cond.get()(alpha, probe)) {
+        break;
+      }
+      alpha = m_geom.nextStep(in_alpha, probe);
       in_alpha.init = alpha;
     }
-    return alpha;
+    return probe.take(alpha);
+  }
+
+private:
+  // The reductions are known in advance, so the next few trial steps (and
+  // alpha = 0 for the conditions) can run while the current one is checked
+  void speculate(AlphaState upcoming, LineProbe &probe) const {
+    std::vector<ScalarType> alphas{0.0, upcoming.init};
+    for (size_t idx = 0; idx < m_speculation; ++idx) {
+      upcoming.init = m_geom.nextStep(upcoming, probe);
+      alphas.push_back(upcoming.init);
+    }
+    probe.speculate(alphas, *m_pool);
   }
 };
 
@@ -29,36 +29,42 @@ public:
       : SearchStrategy(optim), armijo(c_armijo), strong_curvature(c_curv),
         m_step_strategy(stepStrat) {}
 
-  ScalarType search(const AlphaState _in, const FObjFunc &func,
-                    const SearchState &cstate) {
-    auto phi = [&](ScalarType a_val) {
-      return func(cstate.x + a_val * cstate.direction);
-    };
-    auto phi_prime = [&](ScalarType a_val) {
-      return func.directional_derivative(cstate.x + a_val * cstate.direction,
-                                         cstate.direction);
-    };
-
-    ScalarType phi_0 = phi(0.0);
-    ScalarType phi_prime_0 = phi_prime(0.0);
+protected:
+  // Every trial alpha is evaluated once, for both phi and phi'
+  bool slopes() const override { return true; }
 
+  LineProbe::Point run(const AlphaState _in, LineProbe &probe) override {
+    eval::ScopedCallSite site("zoom");
+    if (m_pool != nullptr && m_speculation > 0) {
+      // The bracketing phase doubles alpha up to alpha_max, zoom
+      // interpolants depend on the values so they are not speculated
+      std::vector<ScalarType> alphas{0.0};
+      ScalarType alpha = _in.init;
+      while (alphas.size() < m_speculation + 2) {
+        alphas.push_back(alpha);
+        if (alpha >= _in.hi) {
+          break;
+        }
+        alpha = std::min(alpha * 2, _in.hi);
+      }
+      probe.speculate(alphas, *m_pool);
+    }
     ScalarType alpha_max = _in.hi;
     ScalarType alpha_i = _in.init;
     ScalarType alpha_prev = 0.0; // Initialization corrected
     ScalarType alpha_res = std::numeric_limits<ScalarType>::infinity();
 
     for (size_t idx = 0; idx < 100; idx++) {
-      if ((!armijo(alpha_i, func, cstate) && idx > 0) ||
-          phi(alpha_i) > phi_0 + armijo.c * alpha_i * phi_prime_0) {
-        alpha_res = zoom(alpha_prev, alpha_i, func, cstate);
+      if (!armijo(alpha_i, probe)) {
+        alpha_res = zoom(alpha_prev, alpha_i, probe);
         break;
       }
-      if (strong_curvature(alpha_i, func, cstate)) {
+      if (strong_curvature(alpha_i, probe)) {
         alpha_res = alpha_i;
         break;
       }
-      if (phi_prime(alpha_i) >= 0) {
-        alpha_res = zoom(alpha_i, alpha_prev, func, cstate);
+      if (probe.phi_prime(alpha_i) >= 0) {
+        alpha_res = zoom(alpha_i, alpha_prev, probe);
         break;
       }
       alpha_prev = alpha_i;
@@ -70,31 +76,23 @@ public:
       fmt::print("Failure, falling back to bisection of original interval\n");
       alpha_res = (_in.hi + _in.low) / 2;
     }
-    return alpha_res;
+    return probe.take(alpha_res);
   }
 
-  ScalarType zoom(ScalarType lo, ScalarType hi, const FObjFunc &func,
-                  const SearchState &cstate) {
-    auto phi = [&](ScalarType a_val) {
-      return func(cstate.x + a_val * cstate.direction);
-    };
-
-    auto phi_prime = [&](ScalarType a_val) {
-      return func.directional_derivative(cstate.x + a_val * cstate.direction,
-                                         cstate.direction);
-    };
+public:
 
-    ScalarType alpha_j;      // Uses m_step_strategy below
-    ScalarType previous_phi; // Initialized at the end of the loop
+  ScalarType zoom(ScalarType lo, ScalarType hi, LineProbe &probe) {
+    ScalarType alpha_j = (lo + hi) / 2; // Updated by m_step_strategy below
+    ScalarType previous_phi = probe.phi(lo);
     const ScalarType ftol = this->m_control.ftol;
     const ScalarType xtol = this->m_control.xtol;
     const size_t max_iterations = this->m_control.max_iterations;
 
     for (size_t idx = 0; idx < max_iterations; ++idx) {
       alpha_j = m_step_strategy.get().nextStep(
-          {.init = alpha_j, .low = lo, .hi = hi}, func, cstate);
+          {.init = alpha_j, .low = lo, .hi = hi}, probe);
 
-      ScalarType current_phi = phi(alpha_j);
+      ScalarType current_phi = probe.phi(alpha_j);
       // If the interval is too small, or the function is flat, we are done
       if ((std::abs(current_phi - previous_phi) < ftol ||
            std::abs(hi - lo) < xtol) &&
@@ -102,13 +100,13 @@ public:
         break;
       }
 
-      if (!armijo(alpha_j, func, cstate) || current_phi >= phi(lo)) {
+      if (!armijo(alpha_j, probe) || current_phi >= probe.phi(lo)) {
         hi = alpha_j;
       } else {
-        if (strong_curvature(alpha_j, func, cstate)) {
+        if (strong_curvature(alpha_j, probe)) {
           return alpha_j;
         }
-        if (phi_prime(alpha_j) * (hi - lo) >= 0) {
+        if (probe.phi_prime(alpha_j) * (hi - lo) >= 0) {
           hi = lo;
         }
         lo = alpha_j;
@@ -116,7 +114,7 @@ public:
       previous_phi = current_phi;
     }
     return m_step_strategy.get().nextStep(
-        {.init = alpha_j, .low = lo, .hi = hi}, func, cstate);
+        {.init = alpha_j, .low = lo, .hi = hi}, probe);
   }
 };
 
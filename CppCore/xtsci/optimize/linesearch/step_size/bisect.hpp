@@ -15,8 +15,7 @@ namespace linesearch {
 namespace step_size {
 class BisectionStepSize : public StepSizeStrategy {
 public:
-  ScalarType nextStep(const AlphaState alpha, const FObjFunc &,
-                      const SearchState &) const override {
+  ScalarType nextStep(const AlphaState alpha, LineProbe &) const override {
     return (alpha.low + alpha.hi) / 2.0;
   }
 };
@@ -16,20 +16,19 @@ namespace step_size {
 
 class CubicInterpolationStepSize : public StepSizeStrategy {
 public:
-  ScalarType nextStep(const AlphaState alpha, const FObjFunc &func,
-                      const SearchState &cstate) const override {
+  ScalarType nextStep(const AlphaState alpha,
+                      LineProbe &probe) const override {
     // Can be quicker though
     // fmt::print("Warning: CubicInterpolationStepSize is often unstable and is
     // "
     //            "only provided for reference"
     //            "Use HermiteInterpolationStepSize instead.\n");
-    ScalarType fa = func(cstate.x + alpha.low * cstate.direction);
-    ScalarType fb = func(cstate.x + alpha.hi * cstate.direction);
+    probe.prefetch({alpha.low, alpha.hi}, true);
+    ScalarType fa = probe.phi(alpha.low);
+    ScalarType fb = probe.phi(alpha.hi);
 
-    ScalarType fpa = func.directional_derivative(
-        cstate.x + alpha.low * cstate.direction, cstate.direction);
-    ScalarType fpb = func.directional_derivative(
-        cstate.x + alpha.hi * cstate.direction, cstate.direction);
+    ScalarType fpa = probe.phi_prime(alpha.low);
+    ScalarType fpb = probe.phi_prime(alpha.hi);
 
     ScalarType z = 3.0 * (fa - fb) / (alpha.hi - alpha.low) + fpa + fpb;
     ScalarType w = std::sqrt(std::max(
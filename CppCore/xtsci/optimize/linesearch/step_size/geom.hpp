@@ -20,8 +20,7 @@ private:
 public:
   explicit GeometricReductionStepSize(ScalarType b = 0.5) : beta(b) {}
 
-  ScalarType nextStep(const AlphaState alpha, const FObjFunc &,
-                      const SearchState &) const override {
+  ScalarType nextStep(const AlphaState alpha, LineProbe &) const override {
     return beta * alpha.init;
   }
 };
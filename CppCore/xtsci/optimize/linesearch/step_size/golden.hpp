@@ -16,8 +16,7 @@ namespace step_size {
 class GoldenStepSize : public StepSizeStrategy {
 public:
   static constexpr ScalarType phi = (1 + std::sqrt(5.0)) / 2.0;
-  ScalarType nextStep(const AlphaState alpha, const FObjFunc &,
-                      const SearchState &) const override {
+  ScalarType nextStep(const AlphaState alpha, LineProbe &) const override {
     ScalarType range = alpha.hi - alpha.low;
     ScalarType step = range / phi;
 
@@ -16,16 +16,16 @@ namespace step_size {
 // This will fit a cubic Hermite polynomial to the function and its derivative
 class HermiteInterpolationStepSize : public StepSizeStrategy {
 public:
-  ScalarType nextStep(const AlphaState alpha, const FObjFunc &func,
-                      const SearchState &cstate) const override {
+  ScalarType nextStep(const AlphaState alpha,
+                      LineProbe &probe) const override {
     ScalarType x0 = alpha.low;
     ScalarType x1 = alpha.hi;
-    ScalarType f0 = func(cstate.x + x0 * cstate.direction);
-    ScalarType f1 = func(cstate.x + x1 * cstate.direction);
-    ScalarType df0 = func.directional_derivative(
-        cstate.x + x0 * cstate.direction, cstate.direction);
-    ScalarType df1 = func.directional_derivative(
-        cstate.x + x1 * cstate.direction, cstate.direction);
+    // Typically the bracket ends are already known to the probe
+    probe.prefetch({x0, x1}, true);
+    ScalarType f0 = probe.phi(x0);
+    ScalarType f1 = probe.phi(x1);
+    ScalarType df0 = probe.phi_prime(x0);
+    ScalarType df1 = probe.phi_prime(x1);
 
     // Compute coefficients for the cubic Hermite polynomial
     ScalarType d = f0;
@@ -18,15 +18,12 @@ class QuadraticInterpolationStepSize : public StepSizeStrategy {
 public:
   QuadraticInterpolationStepSize() {}
 
-  ScalarType nextStep(const AlphaState alpha, const FObjFunc &func,
-                      const SearchState &cstate) const override {
-    auto phi = [&](ScalarType a_val) {
-      return func(cstate.x + a_val * cstate.direction);
-    };
-
-    ScalarType phi_low = phi(alpha.low);
-    ScalarType phi_hi = phi(alpha.hi);
-    ScalarType phi_init = phi(alpha.init);
+  ScalarType nextStep(const AlphaState alpha,
+                      LineProbe &probe) const override {
+    probe.prefetch({alpha.low, alpha.hi, alpha.init});
+    ScalarType phi_low = probe.phi(alpha.low);
+    ScalarType phi_hi = probe.phi(alpha.hi);
+    ScalarType phi_init = probe.phi(alpha.init);
 
     ScalarType denominator = (phi_hi - phi_init) * alpha.low +
                              (phi_init - phi_low) * alpha.hi +
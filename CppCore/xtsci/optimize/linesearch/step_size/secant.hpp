@@ -15,14 +15,11 @@ namespace linesearch {
 namespace step_size {
 class SecantStepSize : public StepSizeStrategy {
 public:
-  ScalarType nextStep(const AlphaState alpha, const FObjFunc &func,
-                      const SearchState &cstate) const override {
-    ScalarType fa = func(cstate.x + alpha.low * cstate.direction);
-    ScalarType fb = func(cstate.x + alpha.hi * cstate.direction);
-    ScalarType fpa = func.directional_derivative(
-        cstate.x + alpha.low * cstate.direction, cstate.direction);
-    ScalarType fpb = func.directional_derivative(
-        cstate.x + alpha.hi * cstate.direction, cstate.direction);
+  ScalarType nextStep(const AlphaState alpha,
+                      LineProbe &probe) const override {
+    probe.prefetch({alpha.low, alpha.hi}, true);
+    ScalarType fpa = probe.phi_prime(alpha.low);
+    ScalarType fpb = probe.phi_prime(alpha.hi);
     // Secant method formula
     ScalarType step = alpha.hi - fpb * (alpha.hi - alpha.low) / (fpb - fpa);
     // If the secant value is outside of the interval [low, hi], revert to
@@ -0,0 +1,87 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor/xbuilder.hpp"
+
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/minimize/bfgs.hpp"
+#include "xtsci/optimize/minimize/lbfgs.hpp"
+#include "xtsci/optimize/qn/warm_start.hpp"
+
+namespace xts::optimize::minimize {
+
+void BFGSOptimizer::step(const FObjFunc &func) {
+  eval::ScopedCallSite site("bfgs");
+  auto &ws = m_ws;
+  if (begin_step(func, "BFGS")) {
+    start_inverse(ws.line.x.size());
+  }
+  m_B_inv.symv(-1.0, ws.gradient, ws.line.direction);
+  take_step(func, {1, 1e-6, 1});
+  const ScalarVec &s = ws.s;
+  const ScalarVec &y = ws.y;
+
+  const ScalarType sy = linalg::dot(y, s);
+  // Without positive curvature the update would lose positive definiteness
+  if (sy > 0.0) {
+    const ScalarType rho = 1.0 / sy;
+    m_B_inv.symv(1.0, y, m_u);
+    ScalarType yu = linalg::dot(y, m_u);
+    if (m_result.nit == 0 && m_seeded && !qn::seed_agrees(yu, sy)) {
+      // The imported B_inv is stale here, update the identity instead
+      m_B_inv.set_identity();
+      m_seeded = false;
+      linalg::copy(y, m_u);
+      yu = linalg::dot(y, y);
+    }
+    linalg::axpby(0.5 * (rho + rho * rho * yu), s, -rho, m_u);
+    m_B_inv.syr2(1.0, m_u, s);
+  }
+  if (m_control.get().verbose) {
+    printOptimizationStep(m_result.nit, *ws.energy,
+                          linalg::nrm2(m_next->direction), "BFGS");
+  }
+}
+
+void BFGSOptimizer::start_inverse(size_t ndim) {
+  if (!m_seed && m_warm_start && m_B_inv.size() == ndim) {
+    m_seed = m_B_inv.todense();
+  }
+  m_B_inv.resize(ndim);
+  m_B_inv.set_identity();
+  m_u = xt::zeros<ScalarType>({ndim});
+  m_seeded = false;
+  if (!m_seed) {
+    return;
+  }
+  ScalarMatrix seed = std::move(*m_seed);
+  m_seed.reset();
+  if (seed.dimension() != 2 || seed.shape(0) != ndim ||
+      seed.shape(1) != ndim) {
+    throw std::runtime_error(
+        "Inverse Hessian does not match the problem size.");
+  }
+  // Rounding may have broken the symmetry, a stale B_inv positive
+  // definiteness, then the identity is used as for a cold start
+  seed = 0.5 * (seed + xt::transpose(seed));
+  try {
+    // Succeeds exactly when seed is positive definite
+    xt::linalg::cholesky(seed);
+  } catch (const std::runtime_error &) {
+    return;
+  }
+  m_B_inv.assign(seed);
+  m_seeded = true;
+}
+
+std::shared_ptr<const linalg::LinearOperator>
+BFGSOptimizer::inverse_hessian() const {
+  return std::make_shared<linalg::DenseOperator>(m_B_inv.todense());
+}
+
+} // namespace xts::optimize::minimize
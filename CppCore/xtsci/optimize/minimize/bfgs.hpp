@@ -1,106 +1,69 @@
 #pragma once
 // MIT License
 // Copyright 2023--present Rohit Goswami <HaoZeke>
-#include <fmt/ostream.h>
+#include <memory>
+#include <optional>
+#include <utility>
 
-#include "xtensor/xnoalias.hpp"
+#include "xtensor/xbuilder.hpp"
 
-#include "xtsci/optimize/linesearch/base.hpp"
-
-#include "xtensor-blas/xlinalg.hpp"
+#include "xtsci/optimize/base.hpp"
+#include "xtsci/optimize/linalg/symmetric.hpp"
+#include "xtsci/optimize/numerics.hpp"
 
 namespace xts {
 namespace optimize {
 namespace minimize {
 
-template <typename ScalarType>
-class BFGSOptimizer : public linesearch::LineSearchOptimizer<ScalarType> {
+// Dense BFGS, keeping the n x n inverse Hessian approximation B_inv. The
+// update [NW 6.17] is applied as the equivalent symmetric rank two
+// correction
+//   B_inv += w s^T + s w^T, w = (rho + rho^2 y.u) s / 2 - rho u,
+// with u = B_inv y and rho = 1 / s.y, so a step costs two O(n^2) passes over
+// B_inv. Packed storage halves the memory held for it.
+//
+// References:
+// [NW] Nocedal, J., & Wright, S. J. (2006). Numerical optimization (2nd ed).
+// Springer. Section 6.1
+class BFGSOptimizer : public AbstractOptimizer {
 public:
-  explicit BFGSOptimizer(linesearch::LineSearchStrategy<ScalarType> &strategy)
-      : linesearch::LineSearchOptimizer<ScalarType>(strategy) {}
-
-  OptimizeResult<ScalarType>
-  optimize(const FObjFunc &func, const SearchState<ScalarType> &initial_guess,
-           const OptimizeControl<ScalarType> &control) const override {
-    auto [x, dir_] = initial_guess;
-
-    auto grad_opt = func.gradient(x);
-    if (!grad_opt) {
-      throw std::runtime_error("Gradient required for BFGS method.");
-    }
-
-    auto gradient = *grad_opt;
-    xt::xarray<ScalarType> B_inv = xt::eye({x.size(), x.size()}, 0);
-
-    if (control.verbose) {
-      fmt::print("Initial x: {}\n", x);
-      fmt::print("Initial gradient: {}\n", gradient);
-    }
-
-    OptimizeResult<ScalarType> result;
-
-    xt::xarray<ScalarType> term1({x.size(), x.size()});
-    xt::xarray<ScalarType> term2({x.size(), x.size()});
-    xt::xarray<ScalarType> tmp_matrix({x.size(), x.size()});
-
-    for (result.nit = 0; result.nit < control.max_iterations; ++result.nit) {
-      if (control.verbose) {
-        fmt::print("Iteration: {}\n", result.nit);
-      }
-
-      auto direction = -xt::linalg::dot(B_inv, gradient);
-      ScalarType alpha =
-          this->m_ls_strat.search({1, 1e-6, 1}, func, {x, direction});
-      if (control.verbose) {
-        fmt::print("Alpha: {}\n", alpha);
-      }
-
-      auto s = alpha * direction;
-      xt::noalias(x) += s;
-
-      if (control.verbose) {
-        fmt::print("x: {}\n", x);
-      }
-
-      auto prev_gradient = gradient;
-      auto new_grad_opt = func.gradient(x);
-      if (!new_grad_opt) {
-        throw std::runtime_error("Gradient required for BFGS method.");
-      }
-
-      gradient = *new_grad_opt;
-      auto y = gradient - prev_gradient;
-
-      auto rho = 1.0 / xt::linalg::dot(y, s)();
-
-      xt::noalias(term1) =
-          xt::eye({x.size(), x.size()}, 0) - rho * xt::linalg::outer(s, y);
-      xt::noalias(term2) =
-          xt::eye({x.size(), x.size()}, 0) - rho * xt::linalg::outer(y, s);
-
-      xt::noalias(tmp_matrix) = xt::linalg::dot(B_inv, term2);
-      B_inv =
-          xt::linalg::dot(term1, tmp_matrix) + rho * xt::linalg::outer(s, s);
-
-      if (control.verbose) {
-        fmt::print("New gradient: {}\n", gradient);
-      }
-
-      if (xt::amax(xt::abs(gradient))() < control.tol) {
-        break;
-      }
-    }
-
-    result.x = x;
-    result.fun = func(x);
-    result.jac = gradient;
-    result.nfev = func.evaluation_counts().function_evals;
-    result.njev = func.evaluation_counts().gradient_evals;
-    result.nhev = func.evaluation_counts().hessian_evals;
-    result.nufg = func.evaluation_counts().unique_func_grad;
-
-    return result;
+  explicit BFGSOptimizer(
+      SearchStrategy &strategy,
+      linalg::SymmetricStorage storage = linalg::SymmetricStorage::full)
+      : AbstractOptimizer(strategy), m_B_inv(0, storage) {}
+
+  ScalarMatrix inverse_hessian_matrix() const { return m_B_inv.todense(); }
+
+  // Starts the next run from B_inv of a related one instead of the identity,
+  // a matrix which is not positive definite is dropped, as is one which
+  // disagrees with the first step of the run (see qn::seed_agrees)
+  void import_inverse_hessian(ScalarMatrix B_inv) { m_seed = std::move(B_inv); }
+  // Every run starts from B_inv of the one before when the size is unchanged
+  void set_warm_start(bool warm) { m_warm_start = warm; }
+  // Whether the current run started from an imported B_inv, and kept it
+  bool seeded() const { return m_seeded; }
+
+protected:
+  void step(const FObjFunc &func) override;
+  void save_state(Checkpoint &checkpoint) const override {
+    checkpoint.put("bfgs_inverse_hessian", m_B_inv.todense());
+  }
+  void load_state(const Checkpoint &checkpoint) override {
+    m_B_inv.assign(checkpoint.matrix("bfgs_inverse_hessian"));
+    m_u = xt::zeros<ScalarType>({m_B_inv.size()});
   }
+  std::shared_ptr<const linalg::LinearOperator>
+  inverse_hessian() const override;
+
+private:
+  linalg::SymmetricMatrix m_B_inv;
+  // u = B_inv y, then w of the update
+  ScalarVec m_u;
+  std::optional<ScalarMatrix> m_seed;
+  bool m_warm_start{false};
+  bool m_seeded{false};
+
+  void start_inverse(size_t ndim);
 };
 
 } // namespace minimize
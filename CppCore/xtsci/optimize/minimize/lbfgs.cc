@@ -1,63 +1,164 @@
 // MIT License
 // Copyright 2023--present Rohit Goswami <HaoZeke>
 // clang-format on
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
+#include <type_traits>
 #include <utility>
 // clang-format off
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linalg/kernels.hpp"
 #include "xtsci/optimize/minimize/lbfgs.hpp"
 #include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/qn/inverse_operator.hpp"
 
 namespace xts::optimize::minimize {
 
 void printOptimizationStep(size_t step, const ScalarType &energy,
-                           const ScalarType &fmax) {
+                           const ScalarType &fmax, const char *method) {
   // Get current time
   auto now = std::chrono::system_clock::now();
   auto now_c = std::chrono::system_clock::to_time_t(now);
 
   // Format the output
-  fmt::print("LBFGS: {:3}   {:<8} {:16.9f} {:10.6f}\n", step,
+  fmt::print("{}: {:3}   {:<8} {:16.9f} {:10.6f}\n", method, step,
              fmt::format("{:%H:%M:%S}", *std::localtime(&now_c)), energy, fmax);
 }
 
 void LBFGSOptimizer::step(const FObjFunc &func) {
-  auto [c_x, _dir] = *m_cur;
-  auto [c_grad, c_dir] = get_grad_dir(func, *m_cur);
+  eval::ScopedCallSite site("lbfgs");
+  // Only the workspace and the states are written, no allocations once the
+  // history exists (beyond those of the objective and the line search)
+  auto &ws = m_ws;
+  if (begin_step(func, "L-BFGS")) {
+    start_history(ws.line.x.size());
+  }
+  get_direction(ws.gradient, ws.line.direction);
   // Always try 1 first, but if it fails, search within a larger range
-  ScalarType alpha =
-      this->m_strat.get().search({1, 1e-6, 100}, func, {c_x, c_dir});
-  auto s = alpha * c_dir;
-  auto n_x = c_x + s;
-  m_next = std::make_unique<SearchState>(n_x, *func.gradient(n_x));
-  // TODO(rg): This is very confusing as written, actually y is just delta grad
-  auto y = m_next->direction - c_grad;
-  // Update the lists
-  if (m_s_list.size() == m_corrections) {
-    m_s_list.pop_front();
-    m_y_list.pop_front();
-    m_rho_list.pop_front();
-  }
-  m_s_list.push_back(s);
-  m_y_list.push_back(y);
-  m_rho_list.push_back(1.0 / xt::linalg::dot(y, s)());
+  take_step(func, {1, 1e-6, 100});
+  if (m_result.nit == 0 && m_seeded > 0) {
+    check_seed(ws.s, ws.y, ws.point);
+  }
+  if (m_engine == LBFGSEngine::Compact) {
+    m_compact.push(ws.s, ws.y);
+  } else {
+    std::visit([&](auto &history) { history.push(ws.s, ws.y); }, m_history);
+  }
   if (m_control.get().verbose) {
-    auto energy = func(m_next->x);
-    auto fmax = xt::linalg::norm(m_next->direction);
-    printOptimizationStep(m_result.nit, energy, fmax);
+    auto fmax = linalg::nrm2(m_next->direction);
+    printOptimizationStep(m_result.nit, *ws.energy, fmax);
+  }
+}
+
+void LBFGSOptimizer::start_history(size_t ndim) {
+  if (!m_seed && m_warm_start) {
+    auto previous = export_history();
+    if (previous.size() > 0 && previous.s.shape(1) == ndim) {
+      m_seed = std::move(previous);
+    }
+  }
+  allocate_history(ndim);
+  m_seeded = 0;
+  if (m_seed) {
+    // As qn::seed, stale pairs are dropped
+    const ScalarType min_cosine =
+        std::sqrt(std::numeric_limits<ScalarType>::epsilon());
+    m_seeded = seed_history(*m_seed, min_cosine);
+    m_seed.reset();
+  }
+}
+
+void LBFGSOptimizer::check_seed(const ScalarVec &s, const ScalarVec &y,
+                                ScalarVec &scratch) {
+  // H y, H being linear the -H(-y) of get_direction
+  linalg::axpby(-1.0, y, 0.0, scratch);
+  get_direction(scratch, scratch);
+  if (!qn::seed_agrees(linalg::dot(y, scratch), linalg::dot(s, y))) {
+    allocate_history(s.size());
+    m_seeded = 0;
+  }
+}
+
+void LBFGSOptimizer::allocate_history(size_t ndim) {
+  if (m_engine == LBFGSEngine::Compact) {
+    m_compact.reset(m_corrections, ndim);
+  } else if (m_precision == HistoryPrecision::Single) {
+    m_history.emplace<qn::FloatCurvatureHistory>(m_corrections, ndim);
+  } else if (m_precision == HistoryPrecision::BFloat16) {
+    m_history.emplace<qn::BF16CurvatureHistory>(m_corrections, ndim);
+  } else {
+    m_history.emplace<qn::CurvatureHistory>(m_corrections, ndim);
+  }
+}
+
+size_t LBFGSOptimizer::seed_history(const qn::CurvaturePairs &pairs,
+                                    ScalarType min_cosine) {
+  if (m_engine == LBFGSEngine::Compact) {
+    return qn::seed(m_compact, pairs, min_cosine);
+  }
+  return std::visit(
+      [&](auto &history) { return qn::seed(history, pairs, min_cosine); },
+      m_history);
+}
+
+void LBFGSOptimizer::save_state(Checkpoint &checkpoint) const {
+  auto pairs = export_history();
+  checkpoint.put("lbfgs_s", pairs.s);
+  checkpoint.put("lbfgs_y", pairs.y);
+}
+
+void LBFGSOptimizer::load_state(const Checkpoint &checkpoint) {
+  qn::CurvaturePairs pairs{checkpoint.matrix("lbfgs_s"),
+                           checkpoint.matrix("lbfgs_y")};
+  allocate_history(m_next->x.size());
+  // Every stored pair passed the curvature check once, the cosine test for
+  // stale pairs would change the path
+  seed_history(pairs, 0.0);
+}
+
+qn::CurvaturePairs LBFGSOptimizer::export_history() const {
+  if (m_engine == LBFGSEngine::Compact) {
+    return qn::export_pairs(m_compact.history());
+  }
+  return std::visit(
+      [](const auto &history) { return qn::export_pairs(history); },
+      m_history);
+}
+
+void LBFGSOptimizer::get_direction(const ScalarVec &gradient,
+                                   ScalarVec &direction) const {
+  std::transform(gradient.begin(), gradient.end(), direction.begin(),
+                 [](ScalarType val) { return -val; });
+  // H is linear, so H(-g) = -(H g)
+  if (m_engine == LBFGSEngine::Compact) {
+    m_compact.apply_inverse(direction);
+  } else {
+    std::visit([&](auto &history) { history.apply_inverse(direction); },
+               m_history);
+  }
+}
+
+std::shared_ptr<const linalg::LinearOperator>
+LBFGSOptimizer::inverse_hessian() const {
+  if (m_engine == LBFGSEngine::Compact) {
+    return std::make_shared<qn::CompactInverseOperator>(m_compact);
   }
+  return std::visit(
+      [](const auto &history) -> std::shared_ptr<const linalg::LinearOperator> {
+        return std::make_shared<qn::HistoryInverseOperator<
+            typename std::decay_t<decltype(history)>::StorageType>>(history);
+      },
+      m_history);
 }
 
-std::pair<ScalarVec, ScalarVec>
-LBFGSOptimizer::get_grad_dir(const FObjFunc &func,
-                             const SearchState &state) const {
-  auto [x, _dir] = state;
-  auto grad_opt = func.gradient(x);
-  if (!grad_opt) {
-    throw std::runtime_error("Gradient required for L-BFGS method.");
+size_t LBFGSOptimizer::history_bytes() const {
+  if (m_engine == LBFGSEngine::Compact) {
+    return m_compact.history().memory_bytes();
   }
-  auto gradient = *grad_opt;
-  auto direction = get_direction(gradient, m_s_list, m_y_list, m_rho_list);
-  return std::make_pair(gradient, direction);
+  return std::visit([](const auto &history) { return history.memory_bytes(); },
+                    m_history);
 }
 
 } // namespace xts::optimize::minimize
@@ -4,72 +4,105 @@
 // clang-format off
 #include <fmt/ostream.h>
 #include <fmt/chrono.h>
-#include <deque>
+#include <optional>
+#include <variant>
 #include <vector>
 #include <utility>
 // clang-format on
 
 #include "xtsci/optimize/base.hpp"
 #include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/qn/compact_lbfgs.hpp"
+#include "xtsci/optimize/qn/curvature_history.hpp"
+#include "xtsci/optimize/qn/warm_start.hpp"
 
 namespace xts {
 namespace optimize {
 namespace minimize {
 
 void printOptimizationStep(size_t step, const ScalarType &energy,
-                           const ScalarType &fmax);
+                           const ScalarType &fmax,
+                           const char *method = "LBFGS");
+
+// How the inverse Hessian is applied, both give the same direction
+enum class LBFGSEngine {
+  TwoLoop, // 4m BLAS-1 operations, no extra storage
+  Compact  // two BLAS-2 products, keeps the m x m inner products
+};
+
+// Storage of the two-loop history, the iterate and all sums stay in double
+enum class HistoryPrecision {
+  Double,
+  Single,  // half the memory of Double
+  BFloat16 // a quarter, 8 bit mantissa, for very large n and long memories
+};
 
 class LBFGSOptimizer : public AbstractOptimizer {
 private:
   size_t m_corrections; // Number of corrections to store
-  // Two-deque to store s and y, which represent differences in x and
-  // gradient, respectively
-  std::deque<ScalarVec> m_s_list, m_y_list;
-  std::deque<ScalarType> m_rho_list;
+  LBFGSEngine m_engine;
+  HistoryPrecision m_precision;
+  // Differences in x and gradient, preallocated on the first step, only the
+  // one for the engine in use is filled
+  std::variant<qn::CurvatureHistory, qn::FloatCurvatureHistory,
+               qn::BF16CurvatureHistory>
+      m_history;
+  qn::CompactLBFGS m_compact;
+  // Pairs for the first step of the next run, and whether runs carry their
+  // history over to the next one
+  std::optional<qn::CurvaturePairs> m_seed;
+  bool m_warm_start{false};
+  size_t m_seeded{0};
 
 public:
   explicit LBFGSOptimizer(SearchStrategy &strategy,
-                          size_t mem_list = 2 /* Typically 5 to 20 */)
-      : AbstractOptimizer(strategy) {
+                          size_t mem_list = 2 /* Typically 5 to 20 */,
+                          LBFGSEngine engine = LBFGSEngine::TwoLoop,
+                          HistoryPrecision precision = HistoryPrecision::Double)
+      : AbstractOptimizer(strategy), m_engine{engine}, m_precision{precision} {
+    if (engine == LBFGSEngine::Compact &&
+        precision != HistoryPrecision::Double) {
+      throw std::runtime_error(
+          "The compact L-BFGS engine needs a double precision history.");
+    }
     m_corrections = mem_list;
   }
 
-protected:
-  void step(const FObjFunc &func) override;
+  // Bytes held by the correction pairs
+  size_t history_bytes() const;
 
-private:
-  std::pair<ScalarVec, ScalarVec> get_grad_dir(const FObjFunc &func,
-                                               const SearchState &state) const;
-  ScalarVec get_direction(const ScalarVec &gradient,
-                          const std::deque<ScalarVec> &s_list,
-                          const std::deque<ScalarVec> &y_list,
-                          const std::deque<ScalarType> &rho_list) const {
-    std::vector<ScalarType> alpha_list(m_corrections, 0.0);
-    auto q = gradient;
+  // The compact form, for applying H to other vectors
+  const qn::CompactLBFGS &compact() const { return m_compact; }
 
-    // Two-loop recursion for L-BFGS
-    for (int i = s_list.size() - 1; i >= 0; --i) {
-      alpha_list[i] = rho_list[i] * xt::linalg::dot(s_list[i], q)();
-      q -= alpha_list[i] * y_list[i];
-    }
+  // Correction pairs of the last run, oldest first
+  qn::CurvaturePairs export_history() const;
+  // Seeds the next run with pairs from a related one (e.g. the previous
+  // geometry of a scan), pairs which fail the curvature check are dropped,
+  // and all of them when they disagree with the first step of the run (see
+  // qn::seed_agrees)
+  void import_history(qn::CurvaturePairs pairs) { m_seed = std::move(pairs); }
+  // Every run starts from the pairs of the one before when the problem size
+  // is unchanged, re-checked as for import_history
+  void set_warm_start(bool warm) { m_warm_start = warm; }
+  // Pairs kept when the current run was seeded, 0 once they were dropped
+  size_t seeded() const { return m_seeded; }
 
-    if (!s_list.empty() && !y_list.empty()) {
-      ScalarType scaling_factor =
-          rho_list.back() *
-          xt::linalg::dot(xt::xarray<ScalarType>(s_list.back()),
-                          xt::xarray<ScalarType>(y_list.back()))();
-      q *= scaling_factor;
-    }
-
-    xt::xarray<ScalarType> r = q;
-
-    for (size_t i = 0; i < s_list.size(); ++i) {
-      ScalarType beta = rho_list[i] * xt::linalg::dot(y_list[i], r)();
-      r += s_list[i] * (alpha_list[i] - beta);
-    }
+protected:
+  void step(const FObjFunc &func) override;
+  void save_state(Checkpoint &checkpoint) const override;
+  void load_state(const Checkpoint &checkpoint) override;
+  std::shared_ptr<const linalg::LinearOperator>
+  inverse_hessian() const override;
 
-    return -r;
-  }
+private:
+  // Allocates the history for this run, then seeds it
+  void start_history(size_t ndim);
+  void allocate_history(size_t ndim);
+  size_t seed_history(const qn::CurvaturePairs &pairs, ScalarType min_cosine);
+  // Drops the seeded pairs when they disagree with the first pair of the run
+  void check_seed(const ScalarVec &s, const ScalarVec &y, ScalarVec &scratch);
+  // -H g into direction, of the same size
+  void get_direction(const ScalarVec &gradient, ScalarVec &direction) const;
 };
 } // namespace minimize
 } // namespace optimize
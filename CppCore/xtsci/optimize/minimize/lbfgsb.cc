@@ -0,0 +1,300 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor/xbuilder.hpp"
+
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/minimize/lbfgs.hpp"
+#include "xtsci/optimize/minimize/lbfgsb.hpp"
+#include "xtsci/optimize/qn/inverse_operator.hpp"
+
+namespace xts::optimize::minimize {
+
+LBFGSBOptimizer::LBFGSBOptimizer(SearchStrategy &strategy,
+                                 const ScalarVec &lower,
+                                 const ScalarVec &upper, size_t mem_list)
+    : AbstractOptimizer(strategy), m_lower(lower), m_upper(upper),
+      m_corrections{mem_list} {
+  if (m_lower.size() != m_upper.size()) {
+    throw std::runtime_error("Bounds must have the same size.");
+  }
+  for (size_t idx = 0; idx < m_lower.size(); ++idx) {
+    if (m_lower(idx) > m_upper(idx)) {
+      throw std::runtime_error("Lower bounds must not exceed upper bounds.");
+    }
+  }
+}
+
+ScalarVec LBFGSBOptimizer::project(const ScalarVec &x) const {
+  ScalarVec projected = x;
+  for (size_t idx = 0; idx < x.size(); ++idx) {
+    projected(idx) = std::clamp(x(idx), m_lower(idx), m_upper(idx));
+  }
+  return projected;
+}
+
+ScalarVec LBFGSBOptimizer::projected_gradient(const ScalarVec &x,
+                                              const ScalarVec &gradient) const {
+  return project(x - gradient) - x;
+}
+
+bool LBFGSBOptimizer::converged(const SearchState &) const {
+  if (m_result.nit == 0) {
+    return false;
+  }
+  auto pgrad = projected_gradient(m_next->x, m_next->direction);
+  return xt::amax(xt::abs(pgrad))() < m_control.get().gtol;
+}
+
+void LBFGSBOptimizer::save_state(Checkpoint &checkpoint) const {
+  auto pairs = qn::export_pairs(m_compact.history());
+  checkpoint.put("lbfgsb_s", pairs.s);
+  checkpoint.put("lbfgsb_y", pairs.y);
+}
+
+void LBFGSBOptimizer::load_state(const Checkpoint &checkpoint) {
+  qn::CurvaturePairs pairs{checkpoint.matrix("lbfgsb_s"),
+                           checkpoint.matrix("lbfgsb_y")};
+  m_compact.reset(m_corrections, m_next->x.size());
+  qn::seed(m_compact, pairs, 0.0);
+}
+
+std::shared_ptr<const linalg::LinearOperator>
+LBFGSBOptimizer::inverse_hessian() const {
+  return std::make_shared<qn::CompactInverseOperator>(m_compact);
+}
+
+bool LBFGSBOptimizer::update_middle() {
+  // M^-1 = [ -D    L^T         ]
+  //        [  L    theta S^T S ]
+  // is quasi-definite, so it has LDL^T factors without pivoting
+  const size_t npairs = m_compact.size();
+  m_theta = npairs > 0 ? 1.0 / m_compact.gamma() : 1.0;
+  if (npairs == 0) {
+    m_middle_inverse = ScalarMatrix{};
+    return true;
+  }
+  auto sty = m_compact.sty();
+  auto sts = m_compact.sts();
+  auto &inverse = m_middle_inverse;
+  inverse = xt::zeros<ScalarType>({2 * npairs, 2 * npairs});
+  for (size_t row = 0; row < npairs; ++row) {
+    inverse(row, row) = -sty(row, row);
+    for (size_t col = 0; col < npairs; ++col) {
+      if (row > col) {
+        // L_ij = s_i . y_j for i > j
+        inverse(npairs + row, col) = sty(row, col);
+        inverse(col, npairs + row) = sty(row, col);
+      }
+      inverse(npairs + row, npairs + col) = m_theta * sts(row, col);
+    }
+  }
+  return m_middle.factor(inverse);
+}
+
+ScalarVec LBFGSBOptimizer::middle_dot(const ScalarVec &vec) const {
+  if (m_compact.size() == 0) {
+    return ScalarVec{};
+  }
+  ScalarVec product = vec;
+  m_middle.solve(product);
+  return product;
+}
+
+ScalarVec LBFGSBOptimizer::w_row(size_t idx) const {
+  const size_t npairs = m_compact.size();
+  const auto &history = m_compact.history();
+  const auto &pairs = history.pairs();
+  ScalarVec row = xt::empty<ScalarType>({2 * npairs});
+  for (size_t pair = 0; pair < npairs; ++pair) {
+    const size_t slot = history.slot(pair);
+    row(pair) = pairs(history.rows() + slot, idx);
+    row(npairs + pair) = m_theta * pairs(slot, idx);
+  }
+  return row;
+}
+
+LBFGSBOptimizer::CauchyPoint
+LBFGSBOptimizer::cauchy_point(const ScalarVec &x,
+                              const ScalarVec &gradient) const {
+  // [BLNZ Algorithm CP]
+  const size_t ndim = x.size();
+  const size_t width = 2 * m_compact.size();
+  constexpr ScalarType inf = std::numeric_limits<ScalarType>::infinity();
+
+  CauchyPoint cauchy{x, xt::zeros<ScalarType>({width})};
+  ScalarVec direction = xt::zeros<ScalarType>({ndim});
+  std::vector<std::pair<ScalarType, size_t>> breakpoints;
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    ScalarType brk = inf;
+    if (gradient(idx) < 0.0) {
+      brk = (x(idx) - m_upper(idx)) / gradient(idx);
+    } else if (gradient(idx) > 0.0) {
+      brk = (x(idx) - m_lower(idx)) / gradient(idx);
+    }
+    if (brk > 0.0) {
+      direction(idx) = -gradient(idx);
+      if (brk < inf) {
+        breakpoints.emplace_back(brk, idx);
+      }
+    }
+  }
+  std::sort(breakpoints.begin(), breakpoints.end());
+
+  ScalarVec p_vec = xt::zeros<ScalarType>({width});
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    if (direction(idx) != 0.0) {
+      p_vec += direction(idx) * w_row(idx);
+    }
+  }
+  // First and second derivatives of the model along the path
+  ScalarType fp = -linalg::dot(direction, direction);
+  ScalarType fpp = -m_theta * fp - linalg::dot(p_vec, middle_dot(p_vec));
+  ScalarType dt_min = fpp > 0.0 ? -fp / fpp : 0.0;
+  ScalarType t_old = 0.0;
+  for (const auto &[brk, idx] : breakpoints) {
+    const ScalarType dt = brk - t_old;
+    if (dt_min < dt) {
+      break;
+    }
+    // Variable idx reaches its bound, the path bends there
+    cauchy.x(idx) = direction(idx) > 0.0 ? m_upper(idx) : m_lower(idx);
+    const ScalarType z_b = cauchy.x(idx) - x(idx);
+    const ScalarType g_b = gradient(idx);
+    cauchy.c += dt * p_vec;
+    ScalarVec w_b = w_row(idx);
+    ScalarVec mw_b = middle_dot(w_b);
+    fp += dt * fpp + g_b * g_b + m_theta * g_b * z_b -
+          g_b * linalg::dot(mw_b, cauchy.c);
+    fpp += -m_theta * g_b * g_b - 2.0 * g_b * linalg::dot(mw_b, p_vec) -
+           g_b * g_b * linalg::dot(w_b, mw_b);
+    p_vec += g_b * w_b;
+    direction(idx) = 0.0;
+    dt_min = fpp > 0.0 ? -fp / fpp : 0.0;
+    t_old = brk;
+  }
+  dt_min = std::max<ScalarType>(dt_min, 0.0);
+  t_old += dt_min;
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    if (direction(idx) != 0.0) {
+      cauchy.x(idx) = x(idx) + t_old * direction(idx);
+    }
+  }
+  cauchy.c += dt_min * p_vec;
+  return cauchy;
+}
+
+ScalarVec LBFGSBOptimizer::subspace_minimum(const ScalarVec &x,
+                                            const ScalarVec &gradient,
+                                            const CauchyPoint &cauchy) const {
+  // Direct primal method [BLNZ 5.1], the free variables are those strictly
+  // inside their bounds at the Cauchy point
+  const size_t ndim = x.size();
+  const size_t width = 2 * m_compact.size();
+  std::vector<size_t> free;
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    if (cauchy.x(idx) > m_lower(idx) && cauchy.x(idx) < m_upper(idx)) {
+      free.push_back(idx);
+    }
+  }
+  if (free.empty()) {
+    return cauchy.x;
+  }
+  ScalarVec mc = middle_dot(cauchy.c);
+  // Reduced gradient of the model at the Cauchy point
+  ScalarVec reduced = xt::empty<ScalarType>({free.size()});
+  ScalarVec wz_r = xt::zeros<ScalarType>({width});
+  ScalarMatrix wz_zw = xt::zeros<ScalarType>({width, width});
+  std::vector<ScalarVec> w_free;
+  w_free.reserve(free.size());
+  for (size_t pos = 0; pos < free.size(); ++pos) {
+    const size_t idx = free[pos];
+    w_free.push_back(w_row(idx));
+    const auto &w_i = w_free.back();
+    reduced(pos) = gradient(idx) + m_theta * (cauchy.x(idx) - x(idx)) -
+                   (width > 0 ? linalg::dot(w_i, mc) : 0.0);
+  }
+  ScalarVec d_free = -reduced / m_theta;
+  if (width > 0) {
+    for (size_t pos = 0; pos < free.size(); ++pos) {
+      const auto &w_i = w_free[pos];
+      wz_r += reduced(pos) * w_i;
+      wz_zw += xt::linalg::outer(w_i, w_i);
+    }
+    // (I - M W^T Z Z^T W / theta)^-1 M W^T Z r, by Sherman-Morrison-Woodbury,
+    // which is (M^-1 - W^T Z Z^T W / theta)^-1 W^T Z r without forming M
+    ScalarMatrix system = m_middle_inverse - wz_zw / m_theta;
+    ScalarVec v_vec = xt::linalg::solve(system, wz_r);
+    for (size_t pos = 0; pos < free.size(); ++pos) {
+      d_free(pos) -= linalg::dot(w_free[pos], v_vec) / (m_theta * m_theta);
+    }
+  }
+  // Stay feasible, backtracking towards the Cauchy point
+  ScalarType alpha_star = 1.0;
+  for (size_t pos = 0; pos < free.size(); ++pos) {
+    const size_t idx = free[pos];
+    if (d_free(pos) > 0.0) {
+      alpha_star =
+          std::min(alpha_star, (m_upper(idx) - cauchy.x(idx)) / d_free(pos));
+    } else if (d_free(pos) < 0.0) {
+      alpha_star =
+          std::min(alpha_star, (m_lower(idx) - cauchy.x(idx)) / d_free(pos));
+    }
+  }
+  ScalarVec target = cauchy.x;
+  for (size_t pos = 0; pos < free.size(); ++pos) {
+    target(free[pos]) += alpha_star * d_free(pos);
+  }
+  return target;
+}
+
+void LBFGSBOptimizer::step(const FObjFunc &func) {
+  eval::ScopedCallSite site("lbfgsb");
+  auto &ws = m_ws;
+  if (begin_step()) {
+    ws.line.x = project(ws.line.x);
+    linalg::copy(get_gradient(func, ws.line.x, "L-BFGS-B"), ws.gradient);
+    m_compact.reset(m_corrections, ws.line.x.size());
+  }
+  if (!update_middle()) {
+    // Dependent steps, restart from the identity as [BLNZ] does
+    m_compact.reset(m_corrections, ws.line.x.size());
+    update_middle();
+  }
+  auto cauchy = cauchy_point(ws.line.x, ws.gradient);
+  ws.line.direction =
+      subspace_minimum(ws.line.x, ws.gradient, cauchy) - ws.line.x;
+  if (!(linalg::dot(ws.line.direction, ws.gradient) < 0.0)) {
+    // The subspace step lost descent, the Cauchy point never does
+    ws.line.direction = cauchy.x - ws.line.x;
+  }
+  // Every point of [x, x + d] is feasible, never search beyond it, the
+  // projection only removes rounding past the bounds
+  auto accepted = this->line_search(func, {1, 0, 1}, ws.line, ws.gradient);
+  ScalarType alpha = std::clamp<ScalarType>(accepted.alpha, 0.0, 1.0);
+  ScalarVec n_x = project(ws.line.x + alpha * ws.line.direction);
+  auto n_grad = this->accept(func, std::move(accepted), alpha, n_x).gradient;
+  linalg::copy(n_x, m_next->x);
+  linalg::copy(n_grad, m_next->direction);
+  linalg::copy(n_x, ws.s);
+  linalg::axpy(-1.0, ws.line.x, ws.s);
+  linalg::copy(n_grad, ws.y);
+  linalg::axpy(-1.0, ws.gradient, ws.y);
+  m_compact.push(ws.s, ws.y);
+  if (m_control.get().verbose) {
+    auto pgrad = projected_gradient(m_next->x, m_next->direction);
+    printOptimizationStep(m_result.nit, *ws.energy,
+                          xt::amax(xt::abs(pgrad))(), "LBFGSB");
+  }
+}
+
+} // namespace xts::optimize::minimize
@@ -0,0 +1,78 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+
+#include "xtsci/optimize/base.hpp"
+#include "xtsci/optimize/linalg/ldlt.hpp"
+#include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/qn/compact_lbfgs.hpp"
+
+namespace xts {
+namespace optimize {
+namespace minimize {
+
+// Limited memory BFGS within box constraints lower <= x <= upper, infinite
+// bounds are allowed. Each step finds the generalized Cauchy point along the
+// projected steepest descent path, minimizes the quadratic model over the
+// variables still free there, and runs the line search on the feasible
+// segment alpha in [0, 1] towards that minimizer.
+//
+// The line search is the usual SearchStrategy, called with hi = 1, a
+// backtracking Armijo search is the classic choice.
+//
+// References:
+// [BLNZ] Byrd, R. H., Lu, P., Nocedal, J., & Zhu, C. (1995). A limited memory
+// algorithm for bound constrained optimization. SIAM Journal on Scientific
+// Computing, 16(5), 1190-1208.
+class LBFGSBOptimizer : public AbstractOptimizer {
+public:
+  LBFGSBOptimizer(SearchStrategy &strategy, const ScalarVec &lower,
+                  const ScalarVec &upper, size_t mem_list = 5);
+
+  const ScalarVec &lower() const { return m_lower; }
+  const ScalarVec &upper() const { return m_upper; }
+  ScalarVec project(const ScalarVec &x) const;
+  // P(x - g) - x, zero exactly at a KKT point of the box
+  ScalarVec projected_gradient(const ScalarVec &x,
+                               const ScalarVec &gradient) const;
+
+protected:
+  void step(const FObjFunc &func) override;
+  bool converged(const SearchState &state) const override;
+  void save_state(Checkpoint &checkpoint) const override;
+  void load_state(const Checkpoint &checkpoint) override;
+  // Of the unconstrained model, e.g. to precondition a follow on run
+  std::shared_ptr<const linalg::LinearOperator>
+  inverse_hessian() const override;
+
+private:
+  ScalarVec m_lower, m_upper;
+  size_t m_corrections;
+  qn::CompactLBFGS m_compact;
+  // Middle matrix of B = theta I - W M W^T with W = [Y theta S] [BLNZ 3.3],
+  // kept as M^-1 and its factors, so M v is a solve
+  ScalarMatrix m_middle_inverse;
+  linalg::LDLT m_middle;
+  ScalarType m_theta{1.0};
+
+  struct CauchyPoint {
+    ScalarVec x;
+    ScalarVec c; // W^T (x_cp - x), reused by the subspace minimization
+  };
+
+  // False when M^-1 is singular, the history is then dropped
+  bool update_middle();
+  // M v, empty without pairs
+  ScalarVec middle_dot(const ScalarVec &vec) const;
+  // Row i of W
+  ScalarVec w_row(size_t idx) const;
+  CauchyPoint cauchy_point(const ScalarVec &x,
+                           const ScalarVec &gradient) const;
+  ScalarVec subspace_minimum(const ScalarVec &x, const ScalarVec &gradient,
+                             const CauchyPoint &cauchy) const;
+};
+
+} // namespace minimize
+} // namespace optimize
+} // namespace xts
@@ -0,0 +1,54 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include "xtensor/xbuilder.hpp"
+
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/minimize/lbfgs.hpp"
+#include "xtsci/optimize/minimize/lsr1.hpp"
+
+namespace xts::optimize::minimize {
+
+void LSR1Optimizer::step(const FObjFunc &func) {
+  eval::ScopedCallSite site("lsr1");
+  auto &ws = m_ws;
+  if (begin_step(func, "L-SR1")) {
+    m_sr1 = qn::CompactSR1(m_corrections, ws.line.x.size(), m_skip_tol);
+  }
+  linalg::axpby(-1.0, ws.gradient, 0.0, ws.line.direction);
+  const bool solved = m_sr1.apply_inverse(ws.line.direction);
+  if (!solved || !(linalg::dot(ws.line.direction, ws.gradient) < 0.0)) {
+    // Indefinite H, steepest descent scaled as H_0
+    linalg::axpby(-1.0 / m_sr1.delta(), ws.gradient, 0.0, ws.line.direction);
+  }
+  take_step(func, {1, 1e-6, 1});
+  // Skipped when the SR1 denominator is too small
+  m_sr1.push(ws.s, ws.y);
+  if (m_control.get().verbose) {
+    printOptimizationStep(m_result.nit, *ws.energy,
+                          linalg::nrm2(m_next->direction), "LSR1");
+  }
+}
+
+void LSR1Optimizer::save_state(Checkpoint &checkpoint) const {
+  const size_t npairs = m_sr1.size();
+  const size_t ndim = m_sr1.ndim();
+  ScalarMatrix s = xt::empty<ScalarType>({npairs, ndim});
+  ScalarMatrix y = xt::empty<ScalarType>({npairs, ndim});
+  for (size_t idx = 0; idx < npairs; ++idx) {
+    xt::row(s, idx) = m_sr1.s(idx);
+    xt::row(y, idx) = m_sr1.y(idx);
+  }
+  checkpoint.put("lsr1_s", s);
+  checkpoint.put("lsr1_y", y);
+  checkpoint.put("lsr1_delta", m_sr1.delta());
+}
+
+void LSR1Optimizer::load_state(const Checkpoint &checkpoint) {
+  m_sr1 = qn::CompactSR1(m_corrections, m_next->x.size(), m_skip_tol);
+  // The pairs were checked when first pushed, against the B of that time
+  m_sr1.restore(checkpoint.matrix("lsr1_s"), checkpoint.matrix("lsr1_y"),
+                checkpoint.scalar("lsr1_delta"));
+}
+
+} // namespace xts::optimize::minimize
@@ -0,0 +1,40 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <memory>
+
+#include "xtsci/optimize/base.hpp"
+#include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/qn/compact_sr1.hpp"
+
+namespace xts {
+namespace optimize {
+namespace minimize {
+
+// Limited memory SR1 with a line search, O(mn) per step. H may be
+// indefinite, when -H g is not a descent direction the step falls back to
+// -g / delta.
+class LSR1Optimizer : public AbstractOptimizer {
+public:
+  explicit LSR1Optimizer(SearchStrategy &strategy, size_t mem_list = 5,
+                         ScalarType skip_tol = 1e-8)
+      : AbstractOptimizer(strategy), m_corrections{mem_list},
+        m_skip_tol{skip_tol} {}
+
+  // The compact form, B for trust region models and H
+  const qn::CompactSR1 &compact() const { return m_sr1; }
+
+protected:
+  void step(const FObjFunc &func) override;
+  void save_state(Checkpoint &checkpoint) const override;
+  void load_state(const Checkpoint &checkpoint) override;
+
+private:
+  size_t m_corrections;
+  ScalarType m_skip_tol;
+  qn::CompactSR1 m_sr1;
+};
+
+} // namespace minimize
+} // namespace optimize
+} // namespace xts
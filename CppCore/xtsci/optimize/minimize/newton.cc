@@ -0,0 +1,73 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <stdexcept>
+
+#include "xtensor/xbuilder.hpp"
+
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/minimize/lbfgs.hpp"
+#include "xtsci/optimize/minimize/newton.hpp"
+
+namespace xts::optimize::minimize {
+
+void NewtonOptimizer::step(const FObjFunc &func) {
+  eval::ScopedCallSite site("newton");
+  auto &ws = m_ws;
+  if (begin_step(func, "Newton")) {
+    m_refreshes = 0;
+  }
+  const ScalarType gnorm = linalg::nrm2(ws.gradient);
+  if (m_result.nit == 0 || needs_refresh(gnorm)) {
+    m_modification =
+        m_factors.modified_cholesky(get_hessian(func, ws.line.x));
+    m_refreshes++;
+    m_age = 0;
+  }
+  m_age++;
+  m_gradient_norm = gnorm;
+  // d = -(H + E)^-1 g, the pivots are positive
+  linalg::axpby(-1.0, ws.gradient, 0.0, ws.line.direction);
+  m_factors.solve(ws.line.direction);
+  take_step(func, {1, 1e-6, 1});
+  if (m_control.get().verbose) {
+    printOptimizationStep(m_result.nit, *ws.energy,
+                          linalg::nrm2(m_next->direction), "Newton");
+  }
+}
+
+bool NewtonOptimizer::needs_refresh(ScalarType gnorm) const {
+  return m_age >= m_refresh.interval ||
+         gnorm > m_refresh.stall_ratio * m_gradient_norm;
+}
+
+void NewtonOptimizer::save_state(Checkpoint &checkpoint) const {
+  checkpoint.put("newton_unit_upper", m_factors.unit_upper());
+  checkpoint.put("newton_diagonal", m_factors.diagonal());
+  checkpoint.put_count("newton_age", m_age);
+  checkpoint.put("newton_gradient_norm", m_gradient_norm);
+}
+
+void NewtonOptimizer::load_state(const Checkpoint &checkpoint) {
+  m_factors.restore(checkpoint.matrix("newton_unit_upper"),
+                    checkpoint.vec("newton_diagonal"));
+  m_age = checkpoint.count("newton_age");
+  m_gradient_norm = checkpoint.scalar("newton_gradient_norm");
+}
+
+ScalarMatrix NewtonOptimizer::get_hessian(const FObjFunc &func,
+                                          const ScalarVec &x) const {
+  auto hess_opt = func.hessian(x);
+  if (!hess_opt) {
+    throw std::runtime_error("Hessian required for Newton method.");
+  }
+  const size_t ndim = x.size();
+  if (hess_opt->size() != ndim * ndim) {
+    throw std::runtime_error("Hessian does not match the problem size.");
+  }
+  ScalarMatrix hess = xt::empty<ScalarType>({ndim, ndim});
+  linalg::copy(*hess_opt, hess);
+  return hess;
+}
+
+} // namespace xts::optimize::minimize
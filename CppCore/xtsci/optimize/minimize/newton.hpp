@@ -0,0 +1,70 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+#include <memory>
+
+#include "xtsci/optimize/base.hpp"
+#include "xtsci/optimize/linalg/ldlt.hpp"
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+namespace minimize {
+
+// When NewtonOptimizer factors a fresh Hessian. interval = 1 is Newton's
+// method, m > 1 the Shamanskii variant reusing each factor for m steps
+// [Kel 5.4.3]; a step which reduces |g| by less than the given ratio under a
+// stale factor triggers a refresh early.
+struct HessianRefresh {
+  size_t interval = 1;
+  ScalarType stall_ratio = 0.5;
+};
+
+// Dense Newton with a line search on the analytic Hessian, factored by the
+// Gill-Murray modified Cholesky [NW 3.4], so the direction is one of
+// descent even where the Hessian is indefinite. O(n^3) per refresh and
+// O(n^2) per step otherwise, for small to medium n.
+//
+// References:
+// [NW] Nocedal, J., & Wright, S. J. (2006). Numerical optimization (2nd ed).
+// Springer. Section 3.4
+// [Kel] Kelley, C. T. (1995). Iterative methods for linear and nonlinear
+// equations. SIAM. Section 5.4.3
+class NewtonOptimizer : public AbstractOptimizer {
+public:
+  explicit NewtonOptimizer(SearchStrategy &strategy,
+                           HessianRefresh refresh = HessianRefresh{})
+      : AbstractOptimizer(strategy), m_refresh{refresh} {}
+
+  // Hessians factored over the run
+  size_t refreshes() const { return m_refreshes; }
+  // The largest diagonal shift of the last factor, 0 when no modification
+  // was needed
+  ScalarType modification() const { return m_modification; }
+
+protected:
+  void step(const FObjFunc &func) override;
+  void save_state(Checkpoint &checkpoint) const override;
+  void load_state(const Checkpoint &checkpoint) override;
+  std::shared_ptr<const linalg::LinearOperator>
+  inverse_hessian() const override {
+    return std::make_shared<linalg::LDLTInverseOperator>(m_factors);
+  }
+
+private:
+  HessianRefresh m_refresh;
+  linalg::LDLT m_factors;
+  // Steps taken with the current factor, and |g| where the last one began
+  size_t m_age{0};
+  ScalarType m_gradient_norm{0.0};
+  size_t m_refreshes{0};
+  ScalarType m_modification{0.0};
+
+  bool needs_refresh(ScalarType gnorm) const;
+  ScalarMatrix get_hessian(const FObjFunc &func, const ScalarVec &x) const;
+};
+
+} // namespace minimize
+} // namespace optimize
+} // namespace xts
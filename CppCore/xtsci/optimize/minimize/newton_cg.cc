@@ -0,0 +1,101 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <algorithm>
+#include <cmath>
+
+#include "xtensor/xbuilder.hpp"
+
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/minimize/lbfgs.hpp"
+#include "xtsci/optimize/minimize/newton_cg.hpp"
+
+namespace xts::optimize::minimize {
+
+void NewtonCGOptimizer::step(const FObjFunc &func) {
+  eval::ScopedCallSite site("newton_cg");
+  auto &ws = m_ws;
+  if (begin_step(func, "Newton-CG")) {
+    start_cg(ws.line.x.size());
+  }
+  const ScalarType gnorm = linalg::nrm2(ws.gradient);
+  const ScalarType eta =
+      m_result.nit == 0 ? m_initial_forcing : forcing(gnorm);
+  m_hessian.at(func, ws.line.x, ws.gradient);
+  solve_newton(eta * gnorm);
+  m_forcing = eta;
+  m_gradient_norm = gnorm;
+  const ScalarType alpha = take_step(func, {1, 1e-6, 1});
+  // The model's gradient at the step taken, g + alpha B p, is what the next
+  // gradient is compared with; r = g + B p makes it (1 - alpha) g + alpha r
+  linalg::axpby(1.0 - alpha, ws.gradient, alpha, m_residual);
+  m_residual_norm = linalg::nrm2(m_residual);
+  if (m_control.get().verbose) {
+    printOptimizationStep(m_result.nit, *ws.energy,
+                          linalg::nrm2(m_next->direction), "NewtonCG");
+  }
+}
+
+void NewtonCGOptimizer::start_cg(size_t ndim) {
+  m_hessian.reset(ndim);
+  for (auto *vec : {&m_residual, &m_cg_direction, &m_product}) {
+    *vec = xt::zeros<ScalarType>({ndim});
+  }
+  m_forcing = m_initial_forcing;
+  m_cg_iterations = 0;
+  m_negative_curvature = 0;
+}
+
+ScalarType NewtonCGOptimizer::forcing(ScalarType gnorm) const {
+  // How well the last linear model predicted the new gradient [EW 2.2]
+  ScalarType eta = std::abs(gnorm - m_residual_norm) / m_gradient_norm;
+  // Keeps eta from dropping faster than the convergence rate allows
+  const ScalarType safeguard =
+      std::pow(m_forcing, 0.5 * (1.0 + std::sqrt(5.0)));
+  if (safeguard > 0.1) {
+    eta = std::max(eta, safeguard);
+  }
+  return std::min(eta, m_max_forcing);
+}
+
+ScalarType NewtonCGOptimizer::solve_newton(ScalarType tol) {
+  auto &ws = m_ws;
+  auto &step = ws.line.direction;
+  // r = g + B p, starting from p = 0
+  step.fill(0.0);
+  linalg::copy(ws.gradient, m_residual);
+  linalg::axpby(-1.0, ws.gradient, 0.0, m_cg_direction);
+  ScalarType rr = linalg::dot(m_residual, m_residual);
+  const size_t max_cg = m_max_cg > 0 ? m_max_cg : step.size();
+  for (size_t iter = 0; iter < max_cg && std::sqrt(rr) > tol; ++iter) {
+    m_hessian.multiply(m_cg_direction, m_product);
+    m_cg_iterations++;
+    const ScalarType curvature = linalg::dot(m_cg_direction, m_product);
+    if (!(curvature > 0.0)) {
+      m_negative_curvature++;
+      if (iter == 0) {
+        // Steepest descent, B (-g) is known from the product
+        linalg::copy(m_cg_direction, step);
+        linalg::axpy(1.0, m_product, m_residual);
+        return linalg::nrm2(m_residual);
+      }
+      break;
+    }
+    const ScalarType alpha = rr / curvature;
+    linalg::axpy(alpha, m_cg_direction, step);
+    linalg::axpy(alpha, m_product, m_residual);
+    const ScalarType rr_next = linalg::dot(m_residual, m_residual);
+    linalg::axpby(-1.0, m_residual, rr_next / rr, m_cg_direction);
+    rr = rr_next;
+  }
+  return std::sqrt(rr);
+}
+
+void NewtonCGOptimizer::load_state(const Checkpoint &checkpoint) {
+  start_cg(m_next->x.size());
+  m_forcing = checkpoint.scalar("newton_cg_forcing");
+  m_gradient_norm = checkpoint.scalar("newton_cg_gradient_norm");
+  m_residual_norm = checkpoint.scalar("newton_cg_residual_norm");
+}
+
+} // namespace xts::optimize::minimize
@@ -0,0 +1,73 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+
+#include "xtsci/optimize/base.hpp"
+#include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/trust/model.hpp"
+
+namespace xts {
+namespace optimize {
+namespace minimize {
+
+// Line search Newton-CG [NW Algorithm 7.1]. The Newton system B p = -g is
+// solved by CG from Hessian-vector products (of the objective, or gradient
+// differences) until |g + B p| <= eta |g|, with eta from Eisenstat-Walker
+// choice 1 [EW 2.2] safeguarded as in [EW 2.6], at most eta_max. CG stops
+// early on non-positive curvature, the iterate so far, or -g before the
+// first CG step, is then the direction. Never forms the Hessian.
+//
+// References:
+// [NW] Nocedal, J., & Wright, S. J. (2006). Numerical optimization (2nd ed).
+// Springer. Section 7.1
+// [EW] Eisenstat, S. C., & Walker, H. F. (1996). Choosing the forcing terms
+// in an inexact Newton method. SIAM Journal on Scientific Computing, 17(1),
+// 16-32.
+class NewtonCGOptimizer : public AbstractOptimizer {
+public:
+  // max_cg of 0 allows n CG iterations per step
+  explicit NewtonCGOptimizer(SearchStrategy &strategy, size_t max_cg = 0,
+                             ScalarType initial_forcing = 0.5,
+                             ScalarType max_forcing = 0.9)
+      : AbstractOptimizer(strategy), m_max_cg{max_cg},
+        m_initial_forcing{initial_forcing}, m_max_forcing{max_forcing} {}
+
+  // Hessian-vector products over the run
+  size_t cg_iterations() const { return m_cg_iterations; }
+  // Steps which met non-positive curvature
+  size_t negative_curvature_steps() const { return m_negative_curvature; }
+
+protected:
+  void step(const FObjFunc &func) override;
+  void save_state(Checkpoint &checkpoint) const override {
+    checkpoint.put("newton_cg_forcing", m_forcing);
+    checkpoint.put("newton_cg_gradient_norm", m_gradient_norm);
+    checkpoint.put("newton_cg_residual_norm", m_residual_norm);
+  }
+  void load_state(const Checkpoint &checkpoint) override;
+
+private:
+  size_t m_max_cg;
+  ScalarType m_initial_forcing, m_max_forcing;
+  trust::HessianVectorModel m_hessian;
+  // CG vectors, sized at the start of a run
+  ScalarVec m_residual, m_cg_direction, m_product;
+  // eta, |g| and |g + alpha B p| of the previous step, for the next forcing
+  // term
+  ScalarType m_forcing{0.5};
+  ScalarType m_gradient_norm{0.0};
+  ScalarType m_residual_norm{0.0};
+  size_t m_cg_iterations{0};
+  size_t m_negative_curvature{0};
+
+  void start_cg(size_t ndim);
+  ScalarType forcing(ScalarType gnorm) const;
+  // Direction into m_ws.line.direction, with g + B p left in m_residual.
+  // Returns |g + B p|.
+  ScalarType solve_newton(ScalarType tol);
+};
+
+} // namespace minimize
+} // namespace optimize
+} // namespace xts
@@ -0,0 +1,48 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <initializer_list>
+#include <memory>
+
+#include "xtensor/xbuilder.hpp"
+
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/minimize/lbfgs.hpp"
+#include "xtsci/optimize/minimize/nlcg.hpp"
+
+namespace xts::optimize::minimize {
+
+void ConjugateGradientOptimizer::step(const FObjFunc &func) {
+  eval::ScopedCallSite site("nlcg");
+  // The line search direction of the workspace is kept between steps
+  auto &ws = m_ws;
+  ScalarType beta = 0.0;
+  if (begin_step(func, "conjugate gradient")) {
+    for (auto *vec : {&m_ctx.current_gradient, &m_ctx.previous_gradient,
+                      &m_ctx.previous_direction}) {
+      *vec = xt::zeros<ScalarType>({ws.gradient.size()});
+    }
+  } else {
+    linalg::copy(ws.gradient, m_ctx.current_gradient);
+    // [NJWS] Equation 5.43b
+    beta = m_conj.get().computeBeta(m_ctx);
+    if (m_restart.get().restart(m_ctx)) {
+      beta = 0.0;
+    }
+  }
+  // d <- -g + beta d, a direction which is not downhill restarts as well
+  linalg::axpby(-1.0, ws.gradient, beta, ws.line.direction);
+  if (!(linalg::dot(ws.line.direction, ws.gradient) < 0.0)) {
+    linalg::axpby(-1.0, ws.gradient, 0.0, ws.line.direction);
+  }
+  // [NJWS] Equation 5.43a
+  take_step(func, {1.0, 1e-6, 10}, m_control.get().maxmove);
+  linalg::copy(ws.gradient, m_ctx.previous_gradient);
+  linalg::copy(ws.line.direction, m_ctx.previous_direction);
+  if (m_control.get().verbose) {
+    printOptimizationStep(m_result.nit, *ws.energy,
+                          linalg::nrm2(m_next->direction), "CG");
+  }
+}
+
+} // namespace xts::optimize::minimize
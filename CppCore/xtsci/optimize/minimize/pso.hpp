@@ -2,44 +2,51 @@
 // MIT License
 // Copyright 2023--present Rohit Goswami <HaoZeke>
 #include <fmt/ostream.h>
+#include <cmath>
 #include <limits>
 #include <random>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "xtensor/xarray.hpp"
 #include "xtensor/xmath.hpp"
 #include "xtensor/xnoalias.hpp"
+#include "xtensor/xview.hpp"
 
 #include "xtensor-blas/xlinalg.hpp"
-#include "xtsci/optimize/linesearch/base.hpp"
+#include "xtsci/optimize/base.hpp"
+#include "xtsci/optimize/eval/batch.hpp"
 
 namespace xts {
 namespace optimize {
 namespace minimize {
-template <typename ScalarType> struct Particle {
-  xt::xarray<ScalarType> position;
-  xt::xarray<ScalarType> velocity;
-  xt::xarray<ScalarType> best_position;
+struct Particle {
+  ScalarVec position;
+  ScalarVec velocity;
+  ScalarVec best_position;
   ScalarType best_value;
 };
 
-template <typename ScalarType> class PSOptim {
+class PSOptim {
 private:
-  std::vector<Particle<ScalarType>> swarm;
-  xt::xarray<ScalarType> gbest_position; // global best position
-  ScalarType gbest_value;                // global best value
+  std::vector<Particle> swarm;
+  ScalarVec gbest_position; // global best position
+  ScalarType gbest_value;   // global best value
   ScalarType prev_gbest_value;
   size_t num_particles;
   ScalarType inertia_weight;
   ScalarType cognitive_comp; // cognitive component
   ScalarType social_comp;    // social component
   std::mt19937 rng;          // Mersenne Twister random number generator
-  OptimizeControl<ScalarType> m_control;
+  size_t iteration{0};
+  size_t stagnant_iterations{0};
+  OptimizeControl m_control;
 
 public:
   PSOptim(size_t num_particles = 10, ScalarType inertia = 0.5,
           ScalarType cognitive_comp = 1.5, ScalarType social_comp = 1.5,
-          OptimizeControl<ScalarType> control = OptimizeControl<ScalarType>())
+          OptimizeControl control = OptimizeControl())
       : num_particles(num_particles), inertia_weight(inertia),
         cognitive_comp(cognitive_comp), social_comp(social_comp),
         m_control(control) {
@@ -48,20 +55,27 @@ public:
     prev_gbest_value = std::numeric_limits<ScalarType>::infinity();
   }
 
-  void initialize_swarm(const FObjFunc &func,
-                        const xt::xarray<ScalarType> &lower_bound,
-                        const xt::xarray<ScalarType> &upper_bound) {
+  void initialize_swarm(const FObjFunc &func, const ScalarVec &lower_bound,
+                        const ScalarVec &upper_bound) {
+    swarm.clear();
+    ScalarMatrix positions =
+        xt::empty<ScalarType>({num_particles, lower_bound.size()});
     for (size_t idx = 0; idx < num_particles; ++idx) {
-      Particle<ScalarType> particle;
+      Particle particle;
 
       // Randomly initialize position and velocity
       particle.position = random_position(lower_bound, upper_bound);
       particle.velocity = random_velocity(lower_bound, upper_bound);
       particle.best_position = particle.position;
-      particle.best_value = func(particle.position);
+      xt::row(positions, idx) = particle.position;
 
       swarm.push_back(particle);
+    }
 
+    auto values = eval::evaluate_batch(func, positions).values;
+    for (size_t idx = 0; idx < num_particles; ++idx) {
+      auto &particle = swarm[idx];
+      particle.best_value = values(idx);
       // Update global best if needed
       if (idx == 0 || particle.best_value < gbest_value) {
         gbest_position = particle.best_position;
@@ -70,12 +84,13 @@ public:
     }
   }
 
-  void update_swarm(const FObjFunc &func,
-                    const xt::xarray<ScalarType> &lower_bound,
-                    const xt::xarray<ScalarType> &upper_bound) {
-    size_t idx = 0;
+  void update_swarm(const FObjFunc &func, const ScalarVec &lower_bound,
+                    const ScalarVec &upper_bound) {
     ScalarType Vmax = 0.5 * xt::linalg::norm(upper_bound - lower_bound);
-    for (auto &particle : swarm) {
+    ScalarMatrix positions =
+        xt::empty<ScalarType>({swarm.size(), lower_bound.size()});
+    for (size_t idx = 0; idx < swarm.size(); ++idx) {
+      auto &particle = swarm[idx];
       // Update velocity
       particle.velocity =
           inertia_weight * particle.velocity +
@@ -93,13 +108,19 @@ public:
       particle.position = xt::clip(particle.position, lower_bound, upper_bound);
 
       // Reflective boundary
-      xt::xarray<bool> lower_violation = particle.position == lower_bound;
-      xt::xarray<bool> upper_violation = particle.position == upper_bound;
+      BoolVec lower_violation = xt::equal(particle.position, lower_bound);
+      BoolVec upper_violation = xt::equal(particle.position, upper_bound);
       particle.velocity = xt::where(lower_violation || upper_violation,
                                     -particle.velocity, particle.velocity);
+      xt::row(positions, idx) = particle.position;
+    }
 
-      // Evaluate new position
-      ScalarType new_value = func(particle.position);
+    // Evaluate the new positions together, the swarm is updated
+    // synchronously so the potential can amortize work over the batch
+    auto values = eval::evaluate_batch(func, positions).values;
+    for (size_t idx = 0; idx < swarm.size(); ++idx) {
+      auto &particle = swarm[idx];
+      ScalarType new_value = values(idx);
       if (m_control.verbose) {
         fmt::print("New position for {}: {}\n", idx, particle.position);
       }
@@ -112,47 +133,76 @@ public:
           gbest_value = new_value;
         }
       }
-      idx++;
     }
   }
 
-  xts::optimize::OptimizeResult<ScalarType>
-  optimize(const FObjFunc &func, const xt::xarray<ScalarType> &lower_bound,
-           const xt::xarray<ScalarType> &upper_bound) {
+  OptimizeResult optimize(const FObjFunc &func, const ScalarVec &lower_bound,
+                          const ScalarVec &upper_bound) {
     initialize_swarm(func, lower_bound, upper_bound);
+    iteration = 0;
+    stagnant_iterations = 0;
+    return iterate(func, lower_bound, upper_bound);
+  }
 
-    size_t iteration = 0;
-    size_t stagnant_iterations = 0;
-    while (iteration < m_control.max_iterations) {
-      if (m_control.verbose) {
-        fmt::print("Iteration: {}\n", iteration);
-        fmt::print("Best value: {}\n", gbest_value);
-        fmt::print("Best position: {}\n", gbest_position);
-      }
-      update_swarm(func, lower_bound, upper_bound);
-      ScalarType current_avg_velocity = compute_average_velocity();
-      if (gbest_value == prev_gbest_value) {
-        stagnant_iterations++;
-      } else {
-        stagnant_iterations = 0;
-      }
+  // Continues from a checkpoint of a swarm of the same size, with the random
+  // draws the interrupted run would have made
+  OptimizeResult resume(const FObjFunc &func, const ScalarVec &lower_bound,
+                        const ScalarVec &upper_bound, const std::string &path) {
+    load_state(Checkpoint::load(path));
+    return iterate(func, lower_bound, upper_bound);
+  }
 
-      if (has_converged(stagnant_iterations, current_avg_velocity)) {
-        break;
-      }
-      prev_gbest_value = gbest_value;
+  void checkpoint(const std::string &path) const {
+    Checkpoint checkpoint;
+    save_state(checkpoint);
+    checkpoint.save(path);
+  }
 
-      ++iteration;
+  void save_state(Checkpoint &checkpoint) const {
+    const size_t ndim = gbest_position.size();
+    ScalarMatrix positions = xt::empty<ScalarType>({swarm.size(), ndim});
+    ScalarMatrix velocities = xt::empty<ScalarType>({swarm.size(), ndim});
+    ScalarMatrix best_positions = xt::empty<ScalarType>({swarm.size(), ndim});
+    ScalarVec best_values = xt::empty<ScalarType>({swarm.size()});
+    for (size_t idx = 0; idx < swarm.size(); ++idx) {
+      xt::row(positions, idx) = swarm[idx].position;
+      xt::row(velocities, idx) = swarm[idx].velocity;
+      xt::row(best_positions, idx) = swarm[idx].best_position;
+      best_values(idx) = swarm[idx].best_value;
     }
+    checkpoint.put("pso_positions", positions);
+    checkpoint.put("pso_velocities", velocities);
+    checkpoint.put("pso_best_positions", best_positions);
+    checkpoint.put("pso_best_values", best_values);
+    checkpoint.put("pso_gbest_position", gbest_position);
+    checkpoint.put("pso_gbest_value", gbest_value);
+    checkpoint.put("pso_prev_gbest_value", prev_gbest_value);
+    checkpoint.put_count("nit", iteration);
+    checkpoint.put_count("pso_stagnant_iterations", stagnant_iterations);
+    checkpoint.put_rng("pso_rng", rng);
+  }
 
-    xts::optimize::OptimizeResult<ScalarType> result;
-    result.x = gbest_position;
-    result.fun = gbest_value;
-    result.nit = iteration;
-    result.nfev = func.evaluation_counts().function_evals;
-    result.njev = func.evaluation_counts().gradient_evals;
-    result.nhev = func.evaluation_counts().hessian_evals;
-    return result;
+  void load_state(const Checkpoint &checkpoint) {
+    ScalarMatrix positions = checkpoint.matrix("pso_positions");
+    ScalarMatrix velocities = checkpoint.matrix("pso_velocities");
+    ScalarMatrix best_positions = checkpoint.matrix("pso_best_positions");
+    ScalarVec best_values = checkpoint.vec("pso_best_values");
+    if (positions.shape(0) != num_particles) {
+      throw std::runtime_error("Checkpoint holds a swarm of another size.");
+    }
+    swarm.assign(num_particles, Particle{});
+    for (size_t idx = 0; idx < num_particles; ++idx) {
+      swarm[idx].position = xt::row(positions, idx);
+      swarm[idx].velocity = xt::row(velocities, idx);
+      swarm[idx].best_position = xt::row(best_positions, idx);
+      swarm[idx].best_value = best_values(idx);
+    }
+    gbest_position = checkpoint.vec("pso_gbest_position");
+    gbest_value = checkpoint.scalar("pso_gbest_value");
+    prev_gbest_value = checkpoint.scalar("pso_prev_gbest_value");
+    iteration = checkpoint.count("nit");
+    stagnant_iterations = checkpoint.count("pso_stagnant_iterations");
+    checkpoint.get_rng("pso_rng", rng);
   }
 
   ScalarType random_factor() {
@@ -160,9 +210,8 @@ public:
     return dist(rng);
   }
 
-  xt::xarray<ScalarType> random_position(const xt::xarray<ScalarType> &lower,
-                                         const xt::xarray<ScalarType> &upper) {
-    xt::xarray<ScalarType> position = xt::empty<ScalarType>(lower.shape());
+  ScalarVec random_position(const ScalarVec &lower, const ScalarVec &upper) {
+    ScalarVec position = xt::empty<ScalarType>(lower.shape());
     for (size_t idx = 0; idx < lower.size(); ++idx) {
       std::uniform_real_distribution<ScalarType> dist(lower(idx), upper(idx));
       position(idx) = dist(rng);
@@ -170,12 +219,11 @@ public:
     return position;
   }
 
-  xt::xarray<ScalarType> random_velocity(const xt::xarray<ScalarType> &lower,
-                                         const xt::xarray<ScalarType> &upper) {
-    xt::xarray<ScalarType> velocity = xt::empty<ScalarType>(lower.shape());
+  ScalarVec random_velocity(const ScalarVec &lower, const ScalarVec &upper) {
+    ScalarVec velocity = xt::empty<ScalarType>(lower.shape());
     for (size_t idx = 0; idx < lower.size(); ++idx) {
-      std::uniform_real_distribution<ScalarType> dist(
-          -abs(upper(idx) - lower(idx)), abs(upper(idx) - lower(idx)));
+      ScalarType span = std::abs(upper(idx) - lower(idx));
+      std::uniform_real_distribution<ScalarType> dist(-span, span);
       velocity(idx) = dist(rng);
     }
     return velocity;
@@ -207,6 +255,47 @@ public:
 
     return total_velocity / num_particles;
   }
+
+private:
+  OptimizeResult iterate(const FObjFunc &func, const ScalarVec &lower_bound,
+                         const ScalarVec &upper_bound) {
+    while (iteration < m_control.max_iterations) {
+      if (m_control.verbose) {
+        fmt::print("Iteration: {}\n", iteration);
+        fmt::print("Best value: {}\n", gbest_value);
+        fmt::print("Best position: {}\n", gbest_position);
+      }
+      update_swarm(func, lower_bound, upper_bound);
+      ScalarType current_avg_velocity = compute_average_velocity();
+      if (gbest_value == prev_gbest_value) {
+        stagnant_iterations++;
+      } else {
+        stagnant_iterations = 0;
+      }
+
+      if (has_converged(stagnant_iterations, current_avg_velocity)) {
+        break;
+      }
+      prev_gbest_value = gbest_value;
+
+      ++iteration;
+      if (m_control.checkpoint_interval > 0 &&
+          iteration % m_control.checkpoint_interval == 0) {
+        checkpoint(m_control.checkpoint_path);
+      }
+    }
+
+    OptimizeResult result{};
+    result.x = gbest_position;
+    result.fun = gbest_value;
+    result.nit = iteration;
+    auto counts = eval::tally(func);
+    result.nfev = counts.nfev;
+    result.njev = counts.njev;
+    result.nhev = counts.nhev;
+    result.nfev_cached = counts.nfev_cached;
+    return result;
+  }
 };
 
 } // namespace minimize
@@ -1,102 +1,50 @@
 #pragma once
 // MIT License
 // Copyright 2023--present Rohit Goswami <HaoZeke>
-#include <fmt/ostream.h>
+#include <memory>
 
-#include "xtensor/xnoalias.hpp"
-
-#include "xtsci/optimize/linesearch/base.hpp"
-
-#include "xtensor-blas/xlinalg.hpp"
+#include "xtsci/optimize/base.hpp"
+#include "xtsci/optimize/linalg/ldlt.hpp"
+#include "xtsci/optimize/numerics.hpp"
 
 namespace xts {
 namespace optimize {
 namespace minimize {
 
-template <typename ScalarType>
-class SR1Optimizer : public linesearch::LineSearchOptimizer<ScalarType> {
+// Dense SR1 with a line search, B += r r^T / s.r with r = y - B s [NW 6.24].
+// B is kept as LDL^T factors, so a step is a rank one factor update and two
+// triangular solves, O(n^2). B may be indefinite, when -B^-1 g is not a
+// descent direction the step uses L |D| L^T instead. Pairs are skipped
+// when the denominator is tiny [NW 6.26] or the update would wipe out a
+// pivot.
+//
+// References:
+// [NW] Nocedal, J., & Wright, S. J. (2006). Numerical optimization (2nd ed).
+// Springer. Section 6.2
+class SR1Optimizer : public AbstractOptimizer {
 public:
-  explicit SR1Optimizer(linesearch::LineSearchStrategy<ScalarType> &strategy)
-      : linesearch::LineSearchOptimizer<ScalarType>(strategy) {}
-
-  OptimizeResult<ScalarType>
-  optimize(const FObjFunc &func, const SearchState<ScalarType> &initial_guess,
-           const OptimizeControl<ScalarType> &control) const override {
-    auto [x, dir_] = initial_guess;
-
-    auto grad_opt = func.gradient(x);
-    if (!grad_opt) {
-      throw std::runtime_error("Gradient required for SR1 method.");
-    }
-
-    auto gradient = *grad_opt;
-    xt::xarray<ScalarType> B = xt::eye({x.size(), x.size()}, 0);
-
-    if (control.verbose) {
-      fmt::print("Initial x: {}\n", x);
-      fmt::print("Initial gradient: {}\n", gradient);
-    }
-
-    OptimizeResult<ScalarType> result;
-
-    xt::xarray<ScalarType> term({x.size(), x.size()});
-
-    for (result.nit = 0; result.nit < control.max_iterations; ++result.nit) {
-      if (control.verbose) {
-        fmt::print("Iteration: {}\n", result.nit);
-      }
-
-      auto direction = -xt::linalg::dot(
-          xt::linalg::inv(B),
-          gradient); // TODO(rgoswami): Don't compute the inverse.
-      ScalarType alpha =
-          this->m_ls_strat.search({1, 1e-6, 1}, func, {x, direction});
-      if (control.verbose) {
-        fmt::print("Alpha: {}\n", alpha);
-      }
+  explicit SR1Optimizer(SearchStrategy &strategy, ScalarType skip_tol = 1e-8)
+      : AbstractOptimizer(strategy), m_skip_tol{skip_tol} {}
 
-      auto s = alpha * direction;
-      xt::noalias(x) += s;
+  const linalg::LDLT &factors() const { return m_B; }
 
-      if (control.verbose) {
-        fmt::print("x: {}\n", x);
-      }
-
-      auto prev_gradient = gradient;
-      auto new_grad_opt = func.gradient(x);
-      if (!new_grad_opt) {
-        throw std::runtime_error("Gradient required for SR1 method.");
-      }
-
-      gradient = *new_grad_opt;
-      auto y = gradient - prev_gradient;
-
-      // TODO(rgoswami): Maybe LDLT or something later?
-      auto B_s = xt::linalg::dot(B, s);
-      auto delta = y - B_s;
-      xt::noalias(term) =
-          xt::linalg::outer(delta, delta) / xt::linalg::dot(delta, s)();
-
-      B += term;
-
-      if (control.verbose) {
-        fmt::print("New gradient: {}\n", gradient);
-      }
-
-      if (xt::amax(xt::abs(gradient))() < control.tol) {
-        break;
-      }
-    }
-
-    result.x = x;
-    result.fun = func(x);
-    result.jac = gradient;
-    result.nfev = func.evaluation_counts().function_evals;
-    result.njev = func.evaluation_counts().gradient_evals;
-    result.nhev = func.evaluation_counts().hessian_evals;
-
-    return result;
+protected:
+  void step(const FObjFunc &func) override;
+  void save_state(Checkpoint &checkpoint) const override {
+    checkpoint.put("sr1_unit_upper", m_B.unit_upper());
+    checkpoint.put("sr1_diagonal", m_B.diagonal());
   }
+  void load_state(const Checkpoint &checkpoint) override;
+  std::shared_ptr<const linalg::LinearOperator>
+  inverse_hessian() const override {
+    return std::make_shared<linalg::LDLTInverseOperator>(m_B);
+  }
+
+private:
+  ScalarType m_skip_tol;
+  linalg::LDLT m_B;
+  // r = y - B s
+  ScalarVec m_r;
 };
 
 } // namespace minimize
@@ -0,0 +1,50 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include "xtensor/xbuilder.hpp"
+
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/minimize/lbfgs.hpp"
+#include "xtsci/optimize/minimize/sr2.hpp"
+
+namespace xts::optimize::minimize {
+
+void SR2Optimizer::step(const FObjFunc &func) {
+  eval::ScopedCallSite site("sr2");
+  auto &ws = m_ws;
+  if (begin_step(func, "SR2")) {
+    m_B.reset(ws.line.x.size());
+    m_r = xt::zeros<ScalarType>({ws.line.x.size()});
+  }
+  linalg::axpby(-1.0, ws.gradient, 0.0, ws.line.direction);
+  if (!m_B.solve(ws.line.direction) ||
+      !(linalg::dot(ws.line.direction, ws.gradient) < 0.0)) {
+    // Indefinite B, the same factors with |D|
+    linalg::axpby(-1.0, ws.gradient, 0.0, ws.line.direction);
+    m_B.solve_definite(ws.line.direction);
+  }
+  take_step(func, {1, 1e-6, 1});
+  linalg::copy(ws.s, m_r);
+  m_B.multiply(m_r);
+  linalg::axpby(1.0, ws.y, -1.0, m_r);
+  const ScalarType ss = linalg::dot(ws.s, ws.s);
+  if (ss > 0.0) {
+    // B += u v^T + v u^T with u = s, v = r / s.s - (r.s) s / (2 (s.s)^2)
+    const ScalarType rs = linalg::dot(m_r, ws.s);
+    linalg::axpby(-0.5 * rs / (ss * ss), ws.s, 1.0 / ss, m_r);
+    // Refused, leaving B as it was, if a pivot would cancel
+    m_B.rank_two_update(1.0, ws.s, m_r);
+  }
+  if (m_control.get().verbose) {
+    printOptimizationStep(m_result.nit, *ws.energy,
+                          linalg::nrm2(m_next->direction), "SR2");
+  }
+}
+
+void SR2Optimizer::load_state(const Checkpoint &checkpoint) {
+  m_B.restore(checkpoint.matrix("sr2_unit_upper"),
+              checkpoint.vec("sr2_diagonal"));
+  m_r = xt::zeros<ScalarType>({m_B.size()});
+}
+
+} // namespace xts::optimize::minimize
@@ -1,101 +1,49 @@
 #pragma once
 // MIT License
 // Copyright 2023--present Rohit Goswami <HaoZeke>
-#include <fmt/ostream.h>
+#include <memory>
 
-#include "xtensor/xnoalias.hpp"
-
-#include "xtsci/optimize/linesearch/base.hpp"
-
-#include "xtensor-blas/xlinalg.hpp"
+#include "xtsci/optimize/base.hpp"
+#include "xtsci/optimize/linalg/ldlt.hpp"
+#include "xtsci/optimize/numerics.hpp"
 
 namespace xts {
 namespace optimize {
 namespace minimize {
 
-template <typename ScalarType>
-class SR2Optimizer : public linesearch::LineSearchOptimizer<ScalarType> {
+// Dense symmetric rank two (Powell symmetric Broyden) with a line search,
+//   B += (r s^T + s r^T) / s.s - (r.s) s s^T / (s.s)^2, r = y - B s,
+// the symmetric secant update closest to B in the Frobenius norm [DS 9.1].
+// As for SR1Optimizer, B is kept as LDL^T factors updated in O(n^2), may be
+// indefinite, and steps fall back to L |D| L^T when -B^-1 g is no descent
+// direction.
+//
+// References:
+// [DS] Dennis, J. E., & Schnabel, R. B. (1996). Numerical methods for
+// unconstrained optimization and nonlinear equations. SIAM. Section 9.1
+class SR2Optimizer : public AbstractOptimizer {
 public:
-  explicit SR2Optimizer(linesearch::LineSearchStrategy<ScalarType> &strategy)
-      : linesearch::LineSearchOptimizer<ScalarType>(strategy) {}
-
-  OptimizeResult<ScalarType>
-  optimize(const FObjFunc &func, const SearchState<ScalarType> &initial_guess,
-           const OptimizeControl<ScalarType> &control) const override {
-    auto [x, dir_] = initial_guess;
-
-    auto grad_opt = func.gradient(x);
-    if (!grad_opt) {
-      throw std::runtime_error("Gradient required for SR2 method.");
-    }
-
-    auto gradient = *grad_opt;
-    xt::xarray<ScalarType> B = xt::eye({x.size(), x.size()}, 0);
-
-    if (control.verbose) {
-      fmt::print("Initial x: {}\n", x);
-      fmt::print("Initial gradient: {}\n", gradient);
-    }
-
-    OptimizeResult<ScalarType> result;
-
-    xt::xarray<ScalarType> term({x.size(), x.size()});
-
-    for (result.nit = 0; result.nit < control.max_iterations; ++result.nit) {
-      if (control.verbose) {
-        fmt::print("Iteration: {}\n", result.nit);
-      }
-
-      // TODO(rgoswami): This isn't going to work, need to use an iterative
-      // solver instead
-      auto direction = -xt::linalg::dot(xt::linalg::inv(B), gradient);
-      ScalarType alpha =
-          this->m_ls_strat.search({1, 1e-6, 1}, func, {x, direction});
-      if (control.verbose) {
-        fmt::print("Alpha: {}\n", alpha);
-      }
+  explicit SR2Optimizer(SearchStrategy &strategy)
+      : AbstractOptimizer(strategy) {}
 
-      auto s = alpha * direction;
-      xt::noalias(x) += s;
+  const linalg::LDLT &factors() const { return m_B; }
 
-      if (control.verbose) {
-        fmt::print("x: {}\n", x);
-      }
-
-      auto prev_gradient = gradient;
-      auto new_grad_opt = func.gradient(x);
-      if (!new_grad_opt) {
-        throw std::runtime_error("Gradient required for SR2 method.");
-      }
-
-      gradient = *new_grad_opt;
-      auto y = gradient - prev_gradient;
-
-      auto B_s = xt::linalg::dot(B, s);
-      auto delta = y - B_s;
-      xt::noalias(term) =
-          xt::linalg::outer(delta, y + B_s) / xt::linalg::dot(delta, s)();
-
-      B += term;
-
-      if (control.verbose) {
-        fmt::print("New gradient: {}\n", gradient);
-      }
-
-      if (xt::amax(xt::abs(gradient))() < control.tol) {
-        break;
-      }
-    }
-
-    result.x = x;
-    result.fun = func(x);
-    result.jac = gradient;
-    result.nfev = func.evaluation_counts().function_evals;
-    result.njev = func.evaluation_counts().gradient_evals;
-    result.nhev = func.evaluation_counts().hessian_evals;
-
-    return result;
+protected:
+  void step(const FObjFunc &func) override;
+  void save_state(Checkpoint &checkpoint) const override {
+    checkpoint.put("sr2_unit_upper", m_B.unit_upper());
+    checkpoint.put("sr2_diagonal", m_B.diagonal());
   }
+  void load_state(const Checkpoint &checkpoint) override;
+  std::shared_ptr<const linalg::LinearOperator>
+  inverse_hessian() const override {
+    return std::make_shared<linalg::LDLTInverseOperator>(m_B);
+  }
+
+private:
+  linalg::LDLT m_B;
+  // r = y - B s, then the second vector of the update
+  ScalarVec m_r;
 };
 
 } // namespace minimize
@@ -0,0 +1,55 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <algorithm>
+
+#include "xtsci/optimize/eval/fused.hpp"
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/minimize/lbfgs.hpp"
+#include "xtsci/optimize/minimize/trust_region.hpp"
+
+namespace xts::optimize::minimize {
+
+void TrustRegionOptimizer::step(const FObjFunc &func) {
+  eval::ScopedCallSite site("trust_region");
+  auto &ws = m_ws;
+  auto &model = m_model.get();
+  if (begin_step()) {
+    // f is needed as well, both are evaluated at once
+    model.reset(ws.line.x.size());
+    m_radius = m_initial_radius;
+    linalg::copy(ws.line.x, ws.point);
+    auto [energy, gradient] = eval::value_and_gradient(func, ws.point);
+    m_energy = energy;
+    linalg::copy(gradient, ws.gradient);
+  }
+  model.at(func, ws.line.x, ws.gradient);
+  const auto trial = m_solver.get().solve(model, ws.gradient, m_radius, ws.s);
+  linalg::copy(ws.line.x, ws.point);
+  linalg::axpy(1.0, ws.s, ws.point);
+  auto [energy, n_grad] = eval::value_and_gradient(func, ws.point);
+  linalg::copy(n_grad, ws.y);
+  linalg::axpy(-1.0, ws.gradient, ws.y);
+  model.update(ws.s, ws.y);
+  // Actual over predicted decrease [NW 4.4], a NaN energy counts as a miss
+  const ScalarType ratio =
+      trial.predicted > 0.0 ? (m_energy - energy) / trial.predicted : -1.0;
+  if (!(ratio >= 0.25)) {
+    m_radius *= 0.25;
+  } else if (ratio > 0.75 && trial.boundary) {
+    m_radius = std::min(2.0 * m_radius, m_control.get().maxmove);
+  }
+  if (ratio > m_eta) {
+    linalg::copy(ws.point, m_next->x);
+    linalg::copy(n_grad, m_next->direction);
+    m_energy = energy;
+  } else {
+    linalg::copy(ws.line.x, m_next->x);
+    linalg::copy(ws.gradient, m_next->direction);
+  }
+  if (m_control.get().verbose) {
+    printOptimizationStep(m_result.nit, m_energy,
+                          linalg::nrm2(m_next->direction), "TR");
+  }
+}
+
+} // namespace xts::optimize::minimize
@@ -0,0 +1,62 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <functional>
+
+#include "xtsci/optimize/base.hpp"
+#include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/trust/model.hpp"
+#include "xtsci/optimize/trust/subproblem.hpp"
+
+namespace xts {
+namespace optimize {
+namespace minimize {
+
+// Trust region method [NW Algorithm 4.1], no line search: each iteration
+// minimizes the model within the radius, evaluates the trial point once and
+// accepts it when the actual decrease is at least eta times the predicted
+// one. The radius is quartered below a ratio of 1/4 and doubled, up to
+// maxmove, above 3/4 when the step reached it. The model is updated with
+// every trial step, rejected ones included.
+//
+// References:
+// [NW] Nocedal, J., & Wright, S. J. (2006). Numerical optimization (2nd ed).
+// Springer. Chapters 4 and 7
+class TrustRegionOptimizer : public AbstractOptimizer {
+public:
+  TrustRegionOptimizer(trust::HessianModel &model,
+                       trust::SubproblemSolver &solver,
+                       const OptimizeControl &control,
+                       ScalarType initial_radius = 1.0, ScalarType eta = 1e-4)
+      : AbstractOptimizer(control), m_model(model), m_solver(solver),
+        m_initial_radius{initial_radius}, m_eta{eta} {}
+
+  ScalarType radius() const { return m_radius; }
+
+protected:
+  void step(const FObjFunc &func) override;
+  void save_state(Checkpoint &checkpoint) const override {
+    checkpoint.put("trust_radius", m_radius);
+    checkpoint.put("trust_energy", m_energy);
+    m_model.get().save_state(checkpoint);
+  }
+  void load_state(const Checkpoint &checkpoint) override {
+    m_radius = checkpoint.scalar("trust_radius");
+    m_energy = checkpoint.scalar("trust_energy");
+    m_model.get().reset(m_next->x.size());
+    m_model.get().load_state(checkpoint);
+  }
+
+private:
+  std::reference_wrapper<trust::HessianModel> m_model;
+  std::reference_wrapper<trust::SubproblemSolver> m_solver;
+  ScalarType m_initial_radius;
+  ScalarType m_eta;
+  ScalarType m_radius{1.0};
+  // f at the current iterate, whose gradient the state direction holds
+  ScalarType m_energy{0.0};
+};
+
+} // namespace minimize
+} // namespace optimize
+} // namespace xts
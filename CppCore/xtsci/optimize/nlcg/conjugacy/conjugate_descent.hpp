@@ -7,8 +7,7 @@
 #include <string>
 #include <vector>
 
-#include "xtensor-blas/xlinalg.hpp"
-
+#include "xtsci/optimize/linalg/kernels.hpp"
 #include "xtsci/optimize/nlcg/base.hpp"
 
 namespace xts {
@@ -19,8 +18,8 @@ class ConjugateDescent : public ConjugacyCoefficientStrategy {
 public:
   ScalarType computeBeta(const ConjugacyContext &ctx) const override {
     // [ZJJS] Equation 3
-    return (xt::linalg::dot(ctx.current_gradient, ctx.current_gradient)() /
-            xt::linalg::dot(ctx.previous_direction, ctx.previous_gradient)());
+    return (linalg::dot(ctx.current_gradient, ctx.current_gradient) /
+            linalg::dot(ctx.previous_direction, ctx.previous_gradient));
   }
 
   // References:
@@ -7,8 +7,7 @@
 #include <string>
 #include <vector>
 
-#include "xtensor-blas/xlinalg.hpp"
-
+#include "xtsci/optimize/linalg/kernels.hpp"
 #include "xtsci/optimize/nlcg/base.hpp"
 
 namespace xts {
@@ -18,10 +17,12 @@ namespace conjugacy {
 class ConjugateDescent : public ConjugacyCoefficientStrategy {
 public:
   ScalarType computeBeta(const ConjugacyContext &ctx) const override {
-    auto grad_change = ctx.current_gradient - ctx.previous_gradient;
+    auto [gg, gd] = linalg::multi_dot(ctx.current_gradient,
+                                      ctx.current_gradient,
+                                      ctx.previous_direction);
+    auto gprev_d = linalg::dot(ctx.previous_gradient, ctx.previous_direction);
     // [ZJJS] Equation 3, [NJWS] Equation 5.49
-    return (xt::linalg::dot(ctx.current_gradient, ctx.current_gradient)() /
-            xt::linalg::dot(grad_change, ctx.previous_direction)());
+    return gg / (gd - gprev_d);
   }
 
   // References:
@@ -7,8 +7,7 @@
 #include <string>
 #include <vector>
 
-#include "xtensor-blas/xlinalg.hpp"
-
+#include "xtsci/optimize/linalg/kernels.hpp"
 #include "xtsci/optimize/nlcg/base.hpp"
 
 namespace xts {
@@ -19,8 +18,8 @@ class FletcherReeves : public ConjugacyCoefficientStrategy {
 public:
   ScalarType computeBeta(const ConjugacyContext &ctx) const override {
     // [NJWS] Equation 5.41a
-    return xt::linalg::dot(ctx.current_gradient, ctx.current_gradient)() /
-           xt::linalg::dot(ctx.previous_gradient, ctx.previous_gradient)();
+    return linalg::dot(ctx.current_gradient, ctx.current_gradient) /
+           linalg::dot(ctx.previous_gradient, ctx.previous_gradient);
   }
 
   // References:
@@ -7,8 +7,7 @@
 #include <string>
 #include <vector>
 
-#include "xtensor-blas/xlinalg.hpp"
-
+#include "xtsci/optimize/linalg/kernels.hpp"
 #include "xtsci/optimize/nlcg/base.hpp"
 
 namespace xts {
@@ -18,17 +17,16 @@ namespace conjugacy {
 class HagerZhang : public ConjugacyCoefficientStrategy {
 public:
   ScalarType computeBeta(const ConjugacyContext &ctx) const override {
-    auto grad_change = ctx.current_gradient - ctx.previous_gradient;
-    auto grad_change_norm_sq = xt::linalg::dot(grad_change, grad_change);
-    auto grad_change_prev_dot =
-        xt::linalg::dot(grad_change, ctx.previous_direction);
+    // y is formed since |y|^2 from expanded products would cancel badly
+    ScalarVec grad_change = ctx.current_gradient;
+    linalg::axpy(-1.0, ctx.previous_gradient, grad_change);
+    auto [yy, yd, yg] =
+        linalg::multi_dot(grad_change, grad_change, ctx.previous_direction,
+                          ctx.current_gradient);
+    auto dg = linalg::dot(ctx.previous_direction, ctx.current_gradient);
     // [NJWS] Equation 5.50, [WHHZ] Equation 1.3
-    auto term1 = grad_change - (2 * ctx.previous_direction) *
-                                   (grad_change_norm_sq / grad_change_prev_dot);
-    auto term2 =
-        (xt::linalg::dot(ctx.current_gradient, ctx.current_gradient)() /
-         grad_change_prev_dot);
-    return (term1 * term2)();
+    // beta = (y - 2 d |y|^2 / d.y) . g / d.y
+    return (yg - 2.0 * dg * yy / yd) / yd;
   }
 
   // References:
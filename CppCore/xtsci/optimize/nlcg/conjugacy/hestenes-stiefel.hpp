@@ -7,8 +7,7 @@
 #include <string>
 #include <vector>
 
-#include "xtensor-blas/xlinalg.hpp"
-
+#include "xtsci/optimize/linalg/kernels.hpp"
 #include "xtsci/optimize/nlcg/base.hpp"
 
 namespace xts {
@@ -18,10 +17,12 @@ namespace conjugacy {
 class HestenesStiefel : public ConjugacyCoefficientStrategy {
 public:
   ScalarType computeBeta(const ConjugacyContext &ctx) const override {
-    auto grad_change = ctx.current_gradient - ctx.previous_gradient;
-    // [NJWS] Equation 5.46
-    return (xt::linalg::dot(ctx.current_gradient, grad_change)() /
-            xt::linalg::dot(grad_change, ctx.previous_direction)());
+    auto [gg, g_gprev, gd] =
+        linalg::multi_dot(ctx.current_gradient, ctx.current_gradient,
+                          ctx.previous_gradient, ctx.previous_direction);
+    auto gprev_d = linalg::dot(ctx.previous_gradient, ctx.previous_direction);
+    // [NJWS] Equation 5.46, with y = g - g_prev expanded
+    return (gg - g_gprev) / (gd - gprev_d);
   }
 
   // References:
@@ -7,8 +7,7 @@
 #include <string>
 #include <vector>
 
-#include "xtensor-blas/xlinalg.hpp"
-
+#include "xtsci/optimize/linalg/kernels.hpp"
 #include "xtsci/optimize/nlcg/base.hpp"
 
 namespace xts {
@@ -19,10 +18,10 @@ class LiuStorey : public ConjugacyCoefficientStrategy {
 public:
   ScalarType computeBeta(const ConjugacyContext &ctx) const override {
     // [ZJJS] Equation 3, [LYCS] Equation 10
-    auto grad_change = ctx.current_gradient - ctx.previous_gradient;
-    return -1 *
-           (xt::linalg::dot(ctx.current_gradient, grad_change)() /
-            xt::linalg::dot(ctx.previous_direction, ctx.previous_gradient)());
+    auto [gg, g_gprev] = linalg::multi_dot(
+        ctx.current_gradient, ctx.current_gradient, ctx.previous_gradient);
+    return -1 * ((gg - g_gprev) /
+                 linalg::dot(ctx.previous_direction, ctx.previous_gradient));
   }
 
   // References:
@@ -7,8 +7,7 @@
 #include <string>
 #include <vector>
 
-#include "xtensor-blas/xlinalg.hpp"
-
+#include "xtsci/optimize/linalg/kernels.hpp"
 #include "xtsci/optimize/nlcg/base.hpp"
 
 namespace xts {
@@ -18,10 +17,12 @@ namespace conjugacy {
 class PolakRibiere : public ConjugacyCoefficientStrategy {
 public:
   ScalarType computeBeta(const ConjugacyContext &ctx) const override {
-    auto grad_change = ctx.current_gradient - ctx.previous_gradient;
+    // g . (g - g_prev) without forming the difference
+    auto [gg, g_gprev] = linalg::multi_dot(
+        ctx.current_gradient, ctx.current_gradient, ctx.previous_gradient);
     // [NJWS] Equation 5.44
-    return xt::linalg::dot(ctx.current_gradient, grad_change)() /
-           xt::linalg::dot(ctx.previous_gradient, ctx.previous_gradient)();
+    return (gg - g_gprev) /
+           linalg::dot(ctx.previous_gradient, ctx.previous_gradient);
   }
 
   // References:
@@ -7,8 +7,7 @@
 #include <string>
 #include <vector>
 
-#include "xtensor-blas/xlinalg.hpp"
-
+#include "xtsci/optimize/linalg/kernels.hpp"
 #include "xtsci/optimize/nlcg/base.hpp"
 
 namespace xts {
@@ -22,10 +21,9 @@ public:
   bool restart(const ConjugacyContext &ctx) const override {
     // [NJWS] Equation 5.52
     // Normalized cosine of the angle between the current and previous gradients
-    auto deviation =
-        std::abs(
-            xt::linalg::dot(ctx.current_gradient, ctx.previous_gradient)()) /
-        xt::linalg::dot(ctx.previous_gradient, ctx.previous_gradient)();
+    auto [gprev_g, gprev_gprev] = linalg::multi_dot(
+        ctx.previous_gradient, ctx.current_gradient, ctx.previous_gradient);
+    auto deviation = std::abs(gprev_g) / gprev_gprev;
     return (deviation >= this->m_threshold);
   }
 
@@ -10,4 +10,5 @@ using BoolVec = xt::xtensor<bool, 1>;
 using ScalarVec = xt::xtensor<ScalarType, 1, xt::layout_type::row_major>;
 using ScalarMatrix = xt::xtensor<ScalarType, 2, xt::layout_type::row_major>;
 using FObjFunc = func::ObjectiveFunction<ScalarType>;
+using FuncVec = xt::xarray<ScalarType>; // Argument and gradient of FObjFunc
 } // namespace xts::optimize
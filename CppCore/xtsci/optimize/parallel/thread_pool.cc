@@ -0,0 +1,85 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <algorithm>
+
+#include "xtsci/optimize/parallel/thread_pool.hpp"
+
+namespace xts::optimize::parallel {
+
+namespace {
+// The pool the current thread works for, if any
+thread_local const ThreadPool *t_pool = nullptr;
+} // namespace
+
+ThreadPool::ThreadPool(size_t nthreads) {
+  nthreads = std::max<size_t>(nthreads, 1);
+  m_workers.reserve(nthreads);
+  for (size_t idx = 0; idx < nthreads; ++idx) {
+    m_workers.emplace_back([this]() { work(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  for (auto &worker : m_workers) {
+    worker.join();
+  }
+}
+
+bool ThreadPool::on_worker() const { return t_pool == this; }
+
+void ThreadPool::work() {
+  t_pool = this;
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+      if (m_stop && m_tasks.empty()) {
+        return;
+      }
+      task = std::move(m_tasks.front());
+      m_tasks.pop();
+    }
+    task();
+  }
+}
+
+void ThreadPool::parallel_for(size_t count,
+                              const std::function<void(size_t)> &body) {
+  if (count == 0) {
+    return;
+  }
+  if (on_worker()) {
+    for (size_t idx = 0; idx < count; ++idx) {
+      body(idx);
+    }
+    return;
+  }
+  // Contiguous chunks, one per worker, keep the queue short
+  const size_t nchunks = std::min(count, size());
+  const size_t chunk = (count + nchunks - 1) / nchunks;
+  std::vector<std::future<void>> pending;
+  pending.reserve(nchunks);
+  for (size_t begin = 0; begin < count; begin += chunk) {
+    const size_t end = std::min(begin + chunk, count);
+    pending.push_back(submit([&body, begin, end]() {
+      for (size_t idx = begin; idx < end; ++idx) {
+        body(idx);
+      }
+    }));
+  }
+  // Wait for everything before rethrowing, body may reference our caller
+  for (auto &task : pending) {
+    task.wait();
+  }
+  for (auto &task : pending) {
+    task.get();
+  }
+}
+
+} // namespace xts::optimize::parallel
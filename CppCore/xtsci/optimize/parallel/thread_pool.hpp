@@ -0,0 +1,64 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xts {
+namespace optimize {
+namespace parallel {
+
+// Fixed set of workers fed from a FIFO queue
+class ThreadPool {
+public:
+  explicit ThreadPool(size_t nthreads = std::thread::hardware_concurrency());
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t size() const { return m_workers.size(); }
+
+  template <typename F>
+  auto submit(F &&task) -> std::future<std::invoke_result_t<F>> {
+    using R = std::invoke_result_t<F>;
+    auto packaged =
+        std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+    auto result = packaged->get_future();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_tasks.emplace([packaged]() { (*packaged)(); });
+    }
+    m_cv.notify_one();
+    return result;
+  }
+
+  // Runs body(idx) for every idx in [0, count) and waits for all of them,
+  // rethrowing the first exception raised by a worker. Called from one of
+  // our own workers, e.g. by a batch inside a submitted task, it runs inline
+  // instead, as waiting there could starve the queue it waits on.
+  void parallel_for(size_t count, const std::function<void(size_t)> &body);
+  // Whether the calling thread is one of the workers
+  bool on_worker() const;
+
+private:
+  std::vector<std::thread> m_workers;
+  std::queue<std::function<void()>> m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_stop{false};
+
+  void work();
+};
+
+} // namespace parallel
+} // namespace optimize
+} // namespace xts
@@ -0,0 +1,47 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace xts {
+namespace optimize {
+namespace qn {
+
+// Storage only bfloat16, the upper half of an IEEE float: 8 exponent bits,
+// 7 mantissa bits. Converts to and from float, rounding to nearest even,
+// all arithmetic is meant to happen after converting back.
+struct BFloat16 {
+  uint16_t bits{0};
+
+  BFloat16() = default;
+  template <typename T,
+            typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+  BFloat16(T value) { // NOLINT(runtime/explicit)
+    const auto single = static_cast<float>(value);
+    uint32_t word;
+    std::memcpy(&word, &single, sizeof(word));
+    if (std::isnan(single)) {
+      bits = static_cast<uint16_t>((word >> 16) | 0x0040U); // stay quiet NaN
+      return;
+    }
+    word += 0x7FFFU + ((word >> 16) & 1U);
+    bits = static_cast<uint16_t>(word >> 16);
+  }
+
+  explicit operator float() const {
+    const uint32_t word = static_cast<uint32_t>(bits) << 16;
+    float single;
+    std::memcpy(&single, &word, sizeof(single));
+    return single;
+  }
+  explicit operator double() const {
+    return static_cast<double>(static_cast<float>(*this));
+  }
+};
+
+} // namespace qn
+} // namespace optimize
+} // namespace xts
@@ -0,0 +1,108 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <vector>
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xmanipulation.hpp"
+
+#include "xtsci/optimize/qn/compact_lbfgs.hpp"
+
+namespace xts::optimize::qn {
+
+void CompactLBFGS::reset(size_t capacity, size_t ndim) {
+  m_history.reset(capacity, ndim);
+  m_sty = xt::zeros<ScalarType>({capacity, capacity});
+  m_yty = xt::zeros<ScalarType>({capacity, capacity});
+  m_sts = xt::zeros<ScalarType>({capacity, capacity});
+}
+
+void CompactLBFGS::update(bool dropped_oldest) {
+  const size_t npairs = size();
+  const size_t newest = npairs - 1;
+  if (dropped_oldest) {
+    for (auto *mat : {&m_sty, &m_yty, &m_sts}) {
+      for (size_t row = 0; row < newest; ++row) {
+        for (size_t col = 0; col < newest; ++col) {
+          (*mat)(row, col) = (*mat)(row + 1, col + 1);
+        }
+      }
+    }
+  }
+  // [S Y]^T s_new and [S Y]^T y_new, storage order
+  const size_t rows = m_history.rows();
+  ScalarVec s_new = m_history.s(newest);
+  ScalarVec y_new = m_history.y(newest);
+  ScalarVec with_s = xt::linalg::dot(m_history.pairs(), s_new);
+  ScalarVec with_y = xt::linalg::dot(m_history.pairs(), y_new);
+  for (size_t idx = 0; idx < npairs; ++idx) {
+    const size_t slot = m_history.slot(idx);
+    m_sty(idx, newest) = with_y(slot);
+    m_sty(newest, idx) = with_s(rows + slot);
+    m_yty(idx, newest) = m_yty(newest, idx) = with_y(rows + slot);
+    m_sts(idx, newest) = m_sts(newest, idx) = with_s(slot);
+  }
+}
+
+void CompactLBFGS::coefficients(const ScalarType *projection,
+                                ScalarType *coeffs) const {
+  const size_t npairs = size();
+  const size_t rows = m_history.rows();
+  const ScalarType gamma = m_history.gamma();
+  std::vector<ScalarType> t_vec(npairs), u_vec(npairs);
+  // t = R^-1 S^T v, back substitution on the upper triangle of S^T Y
+  for (size_t idx = npairs; idx-- > 0;) {
+    ScalarType sum = projection[m_history.slot(idx)];
+    for (size_t col = idx + 1; col < npairs; ++col) {
+      sum -= m_sty(idx, col) * t_vec[col];
+    }
+    t_vec[idx] = sum / m_sty(idx, idx);
+  }
+  // u = R^-T ((D + gamma Y^T Y) t - gamma Y^T v), forward substitution
+  for (size_t idx = 0; idx < npairs; ++idx) {
+    ScalarType sum = m_sty(idx, idx) * t_vec[idx] -
+                     gamma * projection[rows + m_history.slot(idx)];
+    for (size_t col = 0; col < npairs; ++col) {
+      sum += gamma * m_yty(idx, col) * t_vec[col];
+    }
+    for (size_t col = 0; col < idx; ++col) {
+      sum -= m_sty(col, idx) * u_vec[col];
+    }
+    u_vec[idx] = sum / m_sty(idx, idx);
+  }
+  // H v = gamma v + S u - gamma Y t
+  for (size_t idx = 0; idx < npairs; ++idx) {
+    coeffs[m_history.slot(idx)] = u_vec[idx];
+    coeffs[rows + m_history.slot(idx)] = -gamma * t_vec[idx];
+  }
+}
+
+void CompactLBFGS::apply_inverse(ScalarVec &v) const {
+  if (size() == 0) {
+    return;
+  }
+  const auto &pairs = m_history.pairs();
+  ScalarVec projection = xt::linalg::dot(pairs, v);
+  ScalarVec coeffs = xt::zeros<ScalarType>({pairs.shape(0)});
+  coefficients(projection.data(), coeffs.data());
+  ScalarVec correction = xt::linalg::dot(xt::transpose(pairs), coeffs);
+  v = m_history.gamma() * v + correction;
+}
+
+void CompactLBFGS::apply_inverse(ScalarMatrix &vectors) const {
+  if (size() == 0) {
+    return;
+  }
+  const auto &pairs = m_history.pairs();
+  const size_t nvec = vectors.shape(0);
+  const size_t width = pairs.shape(0);
+  ScalarMatrix projections = xt::linalg::dot(vectors, xt::transpose(pairs));
+  ScalarMatrix coeffs = xt::zeros<ScalarType>({nvec, width});
+  for (size_t row = 0; row < nvec; ++row) {
+    coefficients(projections.data() + row * width, coeffs.data() + row * width);
+  }
+  ScalarMatrix correction = xt::linalg::dot(coeffs, pairs);
+  vectors = m_history.gamma() * vectors + correction;
+}
+
+} // namespace xts::optimize::qn
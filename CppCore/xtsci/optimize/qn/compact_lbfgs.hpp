@@ -0,0 +1,77 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+
+#include "xtensor/xview.hpp"
+
+#include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/qn/curvature_history.hpp"
+
+namespace xts {
+namespace optimize {
+namespace qn {
+
+// Compact form of the L-BFGS inverse Hessian [BNS 2.6]
+//
+//   H = gamma I + [S Y] N [S Y]^T,
+//   N = [ R^-T (D + gamma Y^T Y) R^-1   -gamma R^-T ]
+//       [ -gamma R^-1                    0          ]
+//
+// with R the upper triangle of S^T Y and D its diagonal. The small matrices
+// are kept up to date with one GEMV per pair, applying H costs one GEMV (or
+// GEMM for several vectors) with [S Y] in each direction plus O(m^2) work.
+//
+// References:
+// [BNS] Byrd, R. H., Nocedal, J., & Schnabel, R. B. (1994). Representations
+// of quasi-Newton matrices and their use in limited memory methods.
+// Mathematical Programming, 63(1), 129-156.
+class CompactLBFGS {
+public:
+  CompactLBFGS() = default;
+  CompactLBFGS(size_t capacity, size_t ndim) { reset(capacity, ndim); }
+
+  void reset(size_t capacity, size_t ndim);
+  void clear() { m_history.clear(); }
+
+  // As CurvatureHistory::push, also updates the small matrices
+  template <typename ES, typename EY> bool push(const ES &s, const EY &y) {
+    const bool full = m_history.size() == m_history.capacity();
+    if (!m_history.push(s, y)) {
+      return false;
+    }
+    update(full);
+    return true;
+  }
+
+  // v <- H v
+  void apply_inverse(ScalarVec &v) const;
+  // Every row of vectors <- H row, as one GEMM each way
+  void apply_inverse(ScalarMatrix &vectors) const;
+
+  size_t size() const { return m_history.size(); }
+  size_t ndim() const { return m_history.ndim(); }
+  ScalarType gamma() const { return m_history.gamma(); }
+  const CurvatureHistory &history() const { return m_history; }
+  // Oldest pair first, (S^T Y)_ij = s_i . y_j
+  auto sty() const { return leading(m_sty); }
+  auto yty() const { return leading(m_yty); }
+  auto sts() const { return leading(m_sts); }
+
+private:
+  CurvatureHistory m_history;
+  ScalarMatrix m_sty, m_yty, m_sts; // capacity x capacity, logical order
+
+  auto leading(const ScalarMatrix &full) const {
+    return xt::view(full, xt::range(0, size()), xt::range(0, size()));
+  }
+  // Adds the products of the newest pair, shifting out the oldest if needed
+  void update(bool dropped_oldest);
+  // Coefficients on the rows of [S Y] from the projections [S Y]^T v, both
+  // laid out as CurvatureHistory::pairs(), coeffs must start out zero
+  void coefficients(const ScalarType *projection, ScalarType *coeffs) const;
+};
+
+} // namespace qn
+} // namespace optimize
+} // namespace xts
@@ -0,0 +1,208 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "xtensor/xbuilder.hpp"
+
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/qn/compact_sr1.hpp"
+
+namespace xts::optimize::qn {
+
+namespace {
+// Gaussian elimination with partial pivoting on the small middle matrix,
+// which is symmetric but may be indefinite. False when it is singular to
+// working precision, rhs then holds garbage.
+bool solve_in_place(ScalarMatrix mat, std::vector<ScalarType> &rhs) {
+  const size_t dim = rhs.size();
+  ScalarType largest = 0.0;
+  for (auto val : mat) {
+    largest = std::max(largest, std::abs(val));
+  }
+  const ScalarType tiny =
+      dim * std::numeric_limits<ScalarType>::epsilon() * largest;
+  for (size_t col = 0; col < dim; ++col) {
+    size_t pivot = col;
+    for (size_t row = col + 1; row < dim; ++row) {
+      if (std::abs(mat(row, col)) > std::abs(mat(pivot, col))) {
+        pivot = row;
+      }
+    }
+    if (!(std::abs(mat(pivot, col)) > tiny)) {
+      return false;
+    }
+    if (pivot != col) {
+      for (size_t idx = 0; idx < dim; ++idx) {
+        std::swap(mat(pivot, idx), mat(col, idx));
+      }
+      std::swap(rhs[pivot], rhs[col]);
+    }
+    for (size_t row = col + 1; row < dim; ++row) {
+      const ScalarType factor = mat(row, col) / mat(col, col);
+      for (size_t idx = col; idx < dim; ++idx) {
+        mat(row, idx) -= factor * mat(col, idx);
+      }
+      rhs[row] -= factor * rhs[col];
+    }
+  }
+  for (size_t row = dim; row-- > 0;) {
+    for (size_t idx = row + 1; idx < dim; ++idx) {
+      rhs[row] -= mat(row, idx) * rhs[idx];
+    }
+    rhs[row] /= mat(row, row);
+  }
+  return true;
+}
+} // namespace
+
+void CompactSR1::reset(size_t capacity, size_t ndim) {
+  m_capacity = capacity;
+  m_ndim = ndim;
+  m_s = xt::zeros<ScalarType>({capacity, ndim});
+  m_y = xt::zeros<ScalarType>({capacity, ndim});
+  m_sts = xt::zeros<ScalarType>({capacity, capacity});
+  m_sty = xt::zeros<ScalarType>({capacity, capacity});
+  m_yty = xt::zeros<ScalarType>({capacity, capacity});
+  clear();
+}
+
+bool CompactSR1::push(const ScalarVec &s, const ScalarVec &y) {
+  if (m_capacity == 0) {
+    return false;
+  }
+  if (m_size == 0) {
+    // Scale B_0 = delta I to the curvature seen along s [NW 6.20]
+    const ScalarType sy = linalg::dot(s, y);
+    m_delta = sy > 0.0 ? linalg::dot(y, y) / sy : 1.0;
+  }
+  // r = y - B s, the SR1 update is r r^T / s.r
+  ScalarVec residual = s;
+  while (!apply(residual)) {
+    // Dropping old pairs can leave M singular, the newer ones may not be;
+    // with none left B = delta I
+    drop_oldest();
+    linalg::copy(s, residual);
+  }
+  linalg::axpby(1.0, y, -1.0, residual);
+  const ScalarType denom = linalg::dot(s, residual);
+  if (!(std::abs(denom) >
+        m_skip_tol * linalg::nrm2(s) * linalg::nrm2(residual))) {
+    return false;
+  }
+  const bool full = m_size == m_capacity;
+  const size_t row = full ? m_head : slot(m_size);
+  linalg::copy(s.data(), m_s.data() + row * m_ndim, m_ndim);
+  linalg::copy(y.data(), m_y.data() + row * m_ndim, m_ndim);
+  if (full) {
+    m_head = (m_head + 1) % m_capacity;
+  } else {
+    m_size++;
+  }
+  update(full);
+  return true;
+}
+
+void CompactSR1::restore(const ScalarMatrix &s, const ScalarMatrix &y,
+                         ScalarType delta) {
+  if (s.shape(1) != m_ndim || y.shape() != s.shape()) {
+    throw std::runtime_error("SR1 pairs do not match the problem size.");
+  }
+  clear();
+  m_delta = delta;
+  const size_t npairs = s.shape(0);
+  for (size_t idx = npairs - std::min(npairs, m_capacity); idx < npairs;
+       ++idx) {
+    linalg::copy(s.data() + idx * m_ndim, m_s.data() + m_size * m_ndim,
+                 m_ndim);
+    linalg::copy(y.data() + idx * m_ndim, m_y.data() + m_size * m_ndim,
+                 m_ndim);
+    m_size++;
+    update(false);
+  }
+}
+
+void CompactSR1::drop_oldest() {
+  shift_products();
+  m_head = slot(1);
+  m_size--;
+}
+
+void CompactSR1::shift_products() {
+  for (auto *mat : {&m_sts, &m_sty, &m_yty}) {
+    for (size_t row = 0; row + 1 < m_size; ++row) {
+      for (size_t col = 0; col + 1 < m_size; ++col) {
+        (*mat)(row, col) = (*mat)(row + 1, col + 1);
+      }
+    }
+  }
+}
+
+void CompactSR1::update(bool dropped_oldest) {
+  const size_t newest = m_size - 1;
+  if (dropped_oldest) {
+    shift_products();
+  }
+  const ScalarType *s_new = m_s.data() + slot(newest) * m_ndim;
+  const ScalarType *y_new = m_y.data() + slot(newest) * m_ndim;
+  for (size_t idx = 0; idx < m_size; ++idx) {
+    const ScalarType *s_row = m_s.data() + slot(idx) * m_ndim;
+    const ScalarType *y_row = m_y.data() + slot(idx) * m_ndim;
+    m_sts(idx, newest) = m_sts(newest, idx) =
+        linalg::dot(s_row, s_new, m_ndim);
+    m_yty(idx, newest) = m_yty(newest, idx) =
+        linalg::dot(y_row, y_new, m_ndim);
+    m_sty(idx, newest) = linalg::dot(s_row, y_new, m_ndim);
+    m_sty(newest, idx) = linalg::dot(s_new, y_row, m_ndim);
+  }
+}
+
+ScalarMatrix CompactSR1::middle_matrix(bool inverse) const {
+  ScalarMatrix mat = xt::empty<ScalarType>({m_size, m_size});
+  for (size_t row = 0; row < m_size; ++row) {
+    for (size_t col = 0; col < m_size; ++col) {
+      if (inverse) {
+        // R + R^T - D - Y^T H_0 Y, R the upper triangle of S^T Y
+        mat(row, col) = (row <= col ? m_sty(row, col) : m_sty(col, row)) -
+                        m_yty(row, col) / m_delta;
+      } else {
+        // D + L + L^T - S^T B_0 S
+        mat(row, col) = (row >= col ? m_sty(row, col) : m_sty(col, row)) -
+                        m_delta * m_sts(row, col);
+      }
+    }
+  }
+  return mat;
+}
+
+bool CompactSR1::multiply(ScalarVec &v, bool inverse) const {
+  // B = delta I + Psi M^-1 Psi^T with Psi = Y - delta S, and H with the roles
+  // of S and Y swapped and 1 / delta
+  const ScalarType scale = inverse ? 1.0 / m_delta : m_delta;
+  const ScalarMatrix &first = inverse ? m_s : m_y;
+  const ScalarMatrix &second = inverse ? m_y : m_s;
+  std::vector<ScalarType> coeffs(m_size);
+  for (size_t idx = 0; idx < m_size; ++idx) {
+    const size_t row = slot(idx) * m_ndim;
+    coeffs[idx] = linalg::dot(first.data() + row, v.data(), m_ndim) -
+                  scale * linalg::dot(second.data() + row, v.data(), m_ndim);
+  }
+  linalg::scal(scale, v);
+  if (m_size == 0) {
+    return true;
+  }
+  if (!solve_in_place(middle_matrix(inverse), coeffs)) {
+    return false;
+  }
+  for (size_t idx = 0; idx < m_size; ++idx) {
+    const size_t row = slot(idx) * m_ndim;
+    linalg::axpy(coeffs[idx], first.data() + row, v.data(), m_ndim);
+    linalg::axpy(-scale * coeffs[idx], second.data() + row, v.data(), m_ndim);
+  }
+  return true;
+}
+
+} // namespace xts::optimize::qn
@@ -0,0 +1,94 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+namespace qn {
+
+// Limited memory SR1 in compact form [BNS 5.2, 5.1],
+//   B = delta I + Psi M^-1 Psi^T, Psi = Y - delta S,
+//   M = D + L + L^T - delta S^T S,
+// with L the strict lower triangle and D the diagonal of S^T Y, and the
+// same for H = B^-1 with S and Y swapped and 1 / delta. Unlike BFGS, pairs
+// with negative curvature are kept, so B can be indefinite. Pairs are
+// skipped when the SR1 denominator is tiny [NW 6.26].
+//
+// delta is y.y / s.y of the pair which starts the history, 1 when that pair
+// has s.y <= 0, and is then kept, so every pair was checked against the B it
+// updates.
+//
+// References:
+// [BNS] Byrd, R. H., Nocedal, J., & Schnabel, R. B. (1994). Representations
+// of quasi-Newton matrices and their use in limited memory methods.
+// Mathematical Programming, 63(1), 129-156.
+// [NW] Nocedal, J., & Wright, S. J. (2006). Numerical optimization (2nd ed).
+// Springer. Section 6.2
+class CompactSR1 {
+public:
+  CompactSR1() = default;
+  CompactSR1(size_t capacity, size_t ndim, ScalarType skip_tol = 1e-8)
+      : m_skip_tol(skip_tol) {
+    reset(capacity, ndim);
+  }
+
+  void reset(size_t capacity, size_t ndim);
+  void clear() {
+    m_head = 0;
+    m_size = 0;
+    m_delta = 1.0;
+  }
+
+  // Stores the pair over the oldest once full, unless
+  // |s.(y - B s)| < skip_tol |s| |y - B s|. Returns whether it was stored.
+  // When M is singular, so B s is unknown, the oldest pairs are dropped
+  // until it is not.
+  bool push(const ScalarVec &s, const ScalarVec &y);
+  // Replaces all pairs and delta without the skip test, e.g. from a
+  // checkpoint, the pairs are oldest first
+  void restore(const ScalarMatrix &s, const ScalarMatrix &y, ScalarType delta);
+
+  // v <- B v
+  bool apply(ScalarVec &v) const { return multiply(v, false); }
+  // v <- H v. Both return false, leaving only the delta I part applied, when
+  // the middle matrix is singular (possible once old pairs are dropped).
+  bool apply_inverse(ScalarVec &v) const { return multiply(v, true); }
+
+  size_t size() const { return m_size; }
+  size_t capacity() const { return m_capacity; }
+  size_t ndim() const { return m_ndim; }
+  ScalarType delta() const { return m_delta; }
+  // Logical index 0 is the oldest pair
+  auto s(size_t idx) const { return xt::row(m_s, slot(idx)); }
+  auto y(size_t idx) const { return xt::row(m_y, slot(idx)); }
+  // M of B, size() x size(), e.g. for a trust region subproblem
+  ScalarMatrix middle() const { return middle_matrix(false); }
+
+private:
+  ScalarMatrix m_s, m_y;            // capacity rows used as a ring
+  ScalarMatrix m_sts, m_sty, m_yty; // capacity x capacity, logical order
+  size_t m_capacity{0}, m_ndim{0};
+  size_t m_head{0}, m_size{0};
+  ScalarType m_delta{1.0};
+  ScalarType m_skip_tol{1e-8};
+
+  size_t slot(size_t idx) const { return (m_head + idx) % m_capacity; }
+  // M of B, or N = R + R^T - D - Y^T Y / delta of H
+  ScalarMatrix middle_matrix(bool inverse) const;
+  bool multiply(ScalarVec &v, bool inverse) const;
+  // The products of the newest pair with all pairs
+  void update(bool dropped_oldest);
+  void drop_oldest();
+  // Moves the products of the pairs after the oldest up by one
+  void shift_products();
+};
+
+} // namespace qn
+} // namespace optimize
+} // namespace xts
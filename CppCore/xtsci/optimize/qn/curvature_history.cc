@@ -0,0 +1,78 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <algorithm>
+
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/qn/curvature_history.hpp"
+
+namespace xts::optimize::qn {
+
+template <typename Storage>
+void BasicCurvatureHistory<Storage>::reset(size_t capacity, size_t ndim) {
+  m_capacity = capacity;
+  m_ndim = ndim;
+  m_rows = capacity + 1;
+  m_pairs = StorageMatrix::from_shape({2 * m_rows, ndim});
+  std::fill(m_pairs.begin(), m_pairs.end(), Storage(0));
+  m_rho.assign(m_rows, 0.0);
+  m_alpha.assign(m_rows, 0.0);
+  m_gamma = 1.0;
+  clear();
+}
+
+template <typename Storage>
+bool BasicCurvatureHistory<Storage>::accept(size_t slot) {
+  Storage *s_row = m_pairs.data() + slot * m_ndim;
+  Storage *y_row = m_pairs.data() + (m_rows + slot) * m_ndim;
+  // Curvature of the pair as stored, so H stays positive definite
+  const ScalarType sy = linalg::dot(s_row, y_row, m_ndim);
+  if (m_capacity == 0 || !(sy > 0.0)) {
+    // Unused rows stay zero, products over all of pairs() rely on it
+    std::fill(s_row, s_row + m_ndim, Storage(0));
+    std::fill(y_row, y_row + m_ndim, Storage(0));
+    return false;
+  }
+  m_rho[slot] = 1.0 / sy;
+  m_gamma = sy / linalg::dot(y_row, y_row, m_ndim);
+  if (m_size == m_capacity) {
+    // The rows of the pair dropped become the spare ones, cleared likewise
+    std::fill_n(m_pairs.data() + m_head * m_ndim, m_ndim, Storage(0));
+    std::fill_n(m_pairs.data() + (m_rows + m_head) * m_ndim, m_ndim,
+                Storage(0));
+    m_head = (m_head + 1) % m_rows;
+  } else {
+    m_size++;
+  }
+  return true;
+}
+
+template <typename Storage>
+void BasicCurvatureHistory<Storage>::apply_inverse(ScalarVec &q,
+                                                   ScalarType *alpha) const {
+  if (m_size == 0) {
+    return;
+  }
+  // Kernels on the raw rows, xtensor expressions here would allocate. The
+  // stored operand is widened, the sums are always in ScalarType.
+  ScalarType *qdata = q.data();
+  const Storage *s_rows = m_pairs.data();
+  const Storage *y_rows = m_pairs.data() + m_rows * m_ndim;
+  for (size_t idx = m_size; idx-- > 0;) {
+    const size_t row = slot(idx);
+    alpha[row] = m_rho[row] * linalg::dot(s_rows + row * m_ndim, qdata, m_ndim);
+    linalg::axpy(-alpha[row], y_rows + row * m_ndim, qdata, m_ndim);
+  }
+  linalg::scal(m_gamma, qdata, m_ndim);
+  for (size_t idx = 0; idx < m_size; ++idx) {
+    const size_t row = slot(idx);
+    const ScalarType beta =
+        m_rho[row] * linalg::dot(y_rows + row * m_ndim, qdata, m_ndim);
+    linalg::axpy(alpha[row] - beta, s_rows + row * m_ndim, qdata, m_ndim);
+  }
+}
+
+template class BasicCurvatureHistory<ScalarType>;
+template class BasicCurvatureHistory<float>;
+template class BasicCurvatureHistory<BFloat16>;
+
+} // namespace xts::optimize::qn
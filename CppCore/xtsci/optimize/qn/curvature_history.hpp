@@ -0,0 +1,105 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+#include <vector>
+
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/qn/bfloat16.hpp"
+
+namespace xts {
+namespace optimize {
+namespace qn {
+
+// The last m correction pairs s = x_{k+1} - x_k, y = g_{k+1} - g_k of a
+// limited memory quasi-Newton method, stored as rows of one preallocated
+// matrix used as a ring, the s rows first and then the y rows. Nothing is
+// allocated after reset().
+//
+// Storage may be narrower than ScalarType (float, BFloat16) to fit a longer
+// memory in the same space. Pairs are rounded when stored, all the products
+// and the vector being multiplied stay in ScalarType.
+//
+// References:
+// [NW] Nocedal, J., & Wright, S. J. (2006). Numerical optimization (2nd ed).
+// Springer. Algorithm 7.4
+template <typename Storage> class BasicCurvatureHistory {
+public:
+  using StorageType = Storage;
+  using StorageMatrix = xt::xtensor<Storage, 2, xt::layout_type::row_major>;
+
+  BasicCurvatureHistory() = default;
+  BasicCurvatureHistory(size_t capacity, size_t ndim) {
+    reset(capacity, ndim);
+  }
+
+  // Allocates storage for capacity pairs of length ndim, dropping all pairs
+  void reset(size_t capacity, size_t ndim);
+  // Drops all pairs, keeps the storage
+  void clear() {
+    m_head = 0;
+    m_size = 0;
+  }
+
+  // Stores a pair over the oldest one once full. Pairs without positive
+  // curvature (y.s <= 0) would make the inverse Hessian indefinite, they are
+  // not stored and false is returned.
+  template <typename ES, typename EY> bool push(const ES &s, const EY &y) {
+    // One spare row beyond capacity, so the oldest pair survives a rejection
+    const size_t slot = (m_head + m_size) % m_rows;
+    Storage *s_row = m_pairs.data() + slot * m_ndim;
+    Storage *y_row = m_pairs.data() + (m_rows + slot) * m_ndim;
+    for (size_t idx = 0; idx < m_ndim; ++idx) {
+      s_row[idx] = static_cast<Storage>(s(idx));
+      y_row[idx] = static_cast<Storage>(y(idx));
+    }
+    return accept(slot);
+  }
+
+  // q <- H q with the two-loop recursion, in place. Uses a workspace of the
+  // history, so concurrent callers pass their own of rows() entries.
+  void apply_inverse(ScalarVec &q) const { apply_inverse(q, m_alpha.data()); }
+  void apply_inverse(ScalarVec &q, ScalarType *alpha) const;
+
+  size_t size() const { return m_size; }
+  size_t capacity() const { return m_capacity; }
+  size_t ndim() const { return m_ndim; }
+  size_t memory_bytes() const { return m_pairs.size() * sizeof(Storage); }
+  // Logical index 0 is the oldest pair
+  auto s(size_t idx) const { return xt::row(m_pairs, slot(idx)); }
+  auto y(size_t idx) const { return xt::row(m_pairs, m_rows + slot(idx)); }
+  ScalarType rho(size_t idx) const { return m_rho[slot(idx)]; }
+  // Storage row of the pair with logical index idx, its y is rows() later
+  size_t slot(size_t idx) const { return (m_head + idx) % m_rows; }
+  size_t rows() const { return m_rows; }
+  // All 2 rows() rows, unused ones are zero, for BLAS-2/3 products
+  const StorageMatrix &pairs() const { return m_pairs; }
+  // Initial inverse Hessian scaling s.y / y.y of the newest pair [NW 7.20]
+  ScalarType gamma() const { return m_gamma; }
+
+private:
+  StorageMatrix m_pairs;
+  std::vector<ScalarType> m_rho;           // 1 / y.s per slot
+  mutable std::vector<ScalarType> m_alpha; // two-loop workspace
+  size_t m_capacity{0}, m_ndim{0}, m_rows{1};
+  size_t m_head{0}, m_size{0};
+  ScalarType m_gamma{1.0};
+
+  bool accept(size_t slot);
+};
+
+using CurvatureHistory = BasicCurvatureHistory<ScalarType>;
+using FloatCurvatureHistory = BasicCurvatureHistory<float>;
+using BF16CurvatureHistory = BasicCurvatureHistory<BFloat16>;
+
+// Instantiated in curvature_history.cc
+extern template class BasicCurvatureHistory<ScalarType>;
+extern template class BasicCurvatureHistory<float>;
+extern template class BasicCurvatureHistory<BFloat16>;
+
+} // namespace qn
+} // namespace optimize
+} // namespace xts
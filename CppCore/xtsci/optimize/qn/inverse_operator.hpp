@@ -0,0 +1,64 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+#include <vector>
+
+#include "xtensor/xbuilder.hpp"
+
+#include "xtsci/optimize/linalg/linear_operator.hpp"
+#include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/qn/compact_lbfgs.hpp"
+#include "xtsci/optimize/qn/curvature_history.hpp"
+
+namespace xts {
+namespace optimize {
+namespace qn {
+
+// The limited memory inverse Hessian as an operator, from a copy of the
+// pairs (O(mn)) so it stays valid after the optimizer moves on. Products may
+// be taken from several threads, each has its own two-loop workspace.
+template <typename Storage>
+class HistoryInverseOperator : public linalg::LinearOperator {
+public:
+  explicit HistoryInverseOperator(const BasicCurvatureHistory<Storage> &history)
+      : m_history(history) {}
+
+  size_t size() const override { return m_history.ndim(); }
+  ScalarVec matvec(const ScalarVec &v) const override {
+    ScalarVec result = v;
+    std::vector<ScalarType> alpha(m_history.rows());
+    m_history.apply_inverse(result, alpha.data());
+    return result;
+  }
+
+private:
+  BasicCurvatureHistory<Storage> m_history;
+};
+
+// As above for the compact form, densifying is a single GEMM
+class CompactInverseOperator : public linalg::LinearOperator {
+public:
+  explicit CompactInverseOperator(const CompactLBFGS &compact)
+      : m_compact(compact) {}
+
+  size_t size() const override { return m_compact.history().ndim(); }
+  ScalarVec matvec(const ScalarVec &v) const override {
+    ScalarVec result = v;
+    m_compact.apply_inverse(result);
+    return result;
+  }
+  ScalarMatrix todense() const override {
+    // H is symmetric, so H I by rows is H
+    ScalarMatrix dense = xt::eye<ScalarType>(size());
+    m_compact.apply_inverse(dense);
+    return dense;
+  }
+
+private:
+  CompactLBFGS m_compact;
+};
+
+} // namespace qn
+} // namespace optimize
+} // namespace xts
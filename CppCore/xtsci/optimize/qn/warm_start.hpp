@@ -0,0 +1,85 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtsci/optimize/numerics.hpp"
+
+namespace xts {
+namespace optimize {
+namespace qn {
+
+// Correction pairs taken out of one optimization to seed another, one pair
+// per row, oldest first
+struct CurvaturePairs {
+  ScalarMatrix s;
+  ScalarMatrix y;
+  size_t size() const { return s.dimension() == 2 ? s.shape(0) : 0; }
+};
+
+template <typename History>
+CurvaturePairs export_pairs(const History &history) {
+  const size_t npairs = history.size();
+  const size_t ndim = history.ndim();
+  CurvaturePairs pairs{xt::empty<ScalarType>({npairs, ndim}),
+                       xt::empty<ScalarType>({npairs, ndim})};
+  for (size_t idx = 0; idx < npairs; ++idx) {
+    auto s_row = history.s(idx);
+    auto y_row = history.y(idx);
+    for (size_t col = 0; col < ndim; ++col) {
+      pairs.s(idx, col) = static_cast<ScalarType>(s_row(col));
+      pairs.y(idx, col) = static_cast<ScalarType>(y_row(col));
+    }
+  }
+  return pairs;
+}
+
+// Pushes pairs oldest first into a history (or compact form) for the same
+// number of variables. Beyond the y.s > 0 check of push a pair must satisfy
+// s.y > min_cosine |s| |y|, which only drops nearly orthogonal pairs: no test
+// on the pairs alone tells whether they still describe the new objective,
+// see seed_agrees for that. Returns the number of pairs kept.
+template <typename History>
+size_t seed(History &history, const CurvaturePairs &pairs,
+            ScalarType min_cosine =
+                std::sqrt(std::numeric_limits<ScalarType>::epsilon())) {
+  if (pairs.size() == 0) {
+    return 0;
+  }
+  if (pairs.s.shape(1) != history.ndim()) {
+    throw std::runtime_error("Curvature pairs do not match the problem size.");
+  }
+  size_t kept = 0;
+  for (size_t idx = 0; idx < pairs.size(); ++idx) {
+    auto s_row = xt::row(pairs.s, idx);
+    auto y_row = xt::row(pairs.y, idx);
+    ScalarType sy = 0.0, ss = 0.0, yy = 0.0;
+    for (size_t col = 0; col < s_row.size(); ++col) {
+      sy += s_row(col) * y_row(col);
+      ss += s_row(col) * s_row(col);
+      yy += y_row(col) * y_row(col);
+    }
+    if (sy > min_cosine * std::sqrt(ss * yy) && history.push(s_row, y_row)) {
+      kept++;
+    }
+  }
+  return kept;
+}
+
+// Whether an inverse Hessian H seeded from another problem is consistent
+// with the first pair (s, y) of the new run. The true inverse of a quadratic
+// has H y = s, so y.H y should be close to s.y; a seed whose curvature along
+// y is off by more than a factor ratio is stale and should be dropped.
+inline bool seed_agrees(ScalarType yhy, ScalarType sy, ScalarType ratio = 10) {
+  return sy > 0.0 && yhy > sy / ratio && yhy < sy * ratio;
+}
+
+} // namespace qn
+} // namespace optimize
+} // namespace xts
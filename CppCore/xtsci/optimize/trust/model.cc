@@ -0,0 +1,119 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cmath>
+#include <stdexcept>
+
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/trust/model.hpp"
+
+namespace xts::optimize::trust {
+
+ScalarMatrix HessianModel::todense() const {
+  const size_t ndim = size();
+  ScalarMatrix dense = xt::empty<ScalarType>({ndim, ndim});
+  ScalarVec unit = xt::zeros<ScalarType>({ndim});
+  ScalarVec column = xt::zeros<ScalarType>({ndim});
+  for (size_t col = 0; col < ndim; ++col) {
+    unit(col) = 1.0;
+    multiply(unit, column);
+    xt::col(dense, col) = column;
+    unit(col) = 0.0;
+  }
+  return dense;
+}
+
+void DenseBFGSModel::reset(size_t ndim) {
+  m_B.resize(ndim);
+  m_B.set_identity();
+  m_bs = xt::zeros<ScalarType>({ndim});
+}
+
+void DenseBFGSModel::update(const ScalarVec &s, const ScalarVec &y) {
+  // B += y y^T / s.y - B s s^T B / s.B s, as two symmetric rank two calls
+  m_B.symv(1.0, s, m_bs);
+  const ScalarType sy = linalg::dot(s, y);
+  const ScalarType sbs = linalg::dot(s, m_bs);
+  if (sy > 0.0 && sbs > 0.0) {
+    m_B.syr2(0.5 / sy, y, y);
+    m_B.syr2(-0.5 / sbs, m_bs, m_bs);
+  }
+}
+
+void DenseBFGSModel::load_state(const Checkpoint &checkpoint) {
+  m_B.assign(checkpoint.matrix("trust_bfgs_hessian"));
+  m_bs = xt::zeros<ScalarType>({m_B.size()});
+}
+
+void DenseSR1Model::reset(size_t ndim) {
+  m_B.resize(ndim);
+  m_B.set_identity();
+  m_r = xt::zeros<ScalarType>({ndim});
+}
+
+void DenseSR1Model::update(const ScalarVec &s, const ScalarVec &y) {
+  m_B.symv(-1.0, s, m_r);
+  linalg::axpy(1.0, y, m_r);
+  const ScalarType denom = linalg::dot(s, m_r);
+  // Skipped when the denominator is tiny [NW 6.26]
+  if (std::abs(denom) > m_skip_tol * linalg::nrm2(s) * linalg::nrm2(m_r)) {
+    m_B.syr2(0.5 / denom, m_r, m_r);
+  }
+}
+
+void DenseSR1Model::load_state(const Checkpoint &checkpoint) {
+  m_B.assign(checkpoint.matrix("trust_sr1_hessian"));
+  m_r = xt::zeros<ScalarType>({m_B.size()});
+}
+
+void CompactSR1Model::multiply(const ScalarVec &v, ScalarVec &out) const {
+  linalg::copy(v, out);
+  // A singular middle matrix leaves delta I, still a usable model
+  m_sr1.apply(out);
+}
+
+void CompactSR1Model::save_state(Checkpoint &checkpoint) const {
+  const size_t npairs = m_sr1.size();
+  const size_t ndim = m_sr1.ndim();
+  ScalarMatrix s = xt::empty<ScalarType>({npairs, ndim});
+  ScalarMatrix y = xt::empty<ScalarType>({npairs, ndim});
+  for (size_t idx = 0; idx < npairs; ++idx) {
+    xt::row(s, idx) = m_sr1.s(idx);
+    xt::row(y, idx) = m_sr1.y(idx);
+  }
+  checkpoint.put("trust_lsr1_s", s);
+  checkpoint.put("trust_lsr1_y", y);
+  checkpoint.put("trust_lsr1_delta", m_sr1.delta());
+}
+
+void CompactSR1Model::load_state(const Checkpoint &checkpoint) {
+  // Sized by reset, as load_state always follows it
+  m_sr1.restore(checkpoint.matrix("trust_lsr1_s"),
+                checkpoint.matrix("trust_lsr1_y"),
+                checkpoint.scalar("trust_lsr1_delta"));
+}
+
+void HessianVectorModel::at(const FObjFunc &func, const ScalarVec &x,
+                            const ScalarVec &gradient) {
+  m_x = x;
+  m_products = dynamic_cast<const eval::HessianVectorProduct *>(&func);
+  if (m_products == nullptr) {
+    m_difference.emplace(func);
+    m_difference->set_base(m_x, FuncVec(gradient));
+  }
+}
+
+void HessianVectorModel::multiply(const ScalarVec &v, ScalarVec &out) const {
+  const FuncVec dir = v;
+  if (m_products != nullptr) {
+    linalg::copy(m_products->hvp(m_x, dir), out);
+  } else if (m_difference) {
+    linalg::copy(m_difference->hvp(m_x, dir), out);
+  } else {
+    throw std::runtime_error("Hessian-vector model used before at().");
+  }
+}
+
+} // namespace xts::optimize::trust
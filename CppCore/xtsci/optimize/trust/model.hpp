@@ -0,0 +1,145 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+#include <optional>
+
+#include "xtsci/optimize/checkpoint.hpp"
+#include "xtsci/optimize/eval/hvp.hpp"
+#include "xtsci/optimize/linalg/symmetric.hpp"
+#include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/qn/compact_sr1.hpp"
+
+namespace xts {
+namespace optimize {
+namespace trust {
+
+// The curvature B of the quadratic model
+//   m(p) = f + g.p + p.B p / 2
+// around the current iterate, known to the subproblem solvers only through
+// products unless they ask for todense()
+class HessianModel {
+public:
+  virtual ~HessianModel() = default;
+
+  // Start of a run in ndim dimensions
+  virtual void reset(size_t ndim) = 0;
+  // The model is about to be used around x, where the gradient is g
+  virtual void at(const FObjFunc &, const ScalarVec &, const ScalarVec &) {}
+  // out <- B v
+  virtual void multiply(const ScalarVec &v, ScalarVec &out) const = 0;
+  // The trial step s and the change of the gradient along it, given for
+  // rejected steps too
+  virtual void update(const ScalarVec &, const ScalarVec &) {}
+
+  virtual size_t size() const = 0;
+  // n products unless overridden, for the small problems of the dogleg and
+  // exact solvers
+  virtual ScalarMatrix todense() const;
+
+  // For checkpoints, load_state is called after reset
+  virtual void save_state(Checkpoint &) const {}
+  virtual void load_state(const Checkpoint &) {}
+};
+
+// Dense B = I at the start, updated by BFGS [NW 6.19] when s.y > 0, so it
+// stays positive definite
+class DenseBFGSModel : public HessianModel {
+public:
+  explicit DenseBFGSModel(
+      linalg::SymmetricStorage storage = linalg::SymmetricStorage::full)
+      : m_B(0, storage) {}
+
+  void reset(size_t ndim) override;
+  void multiply(const ScalarVec &v, ScalarVec &out) const override {
+    m_B.symv(1.0, v, out);
+  }
+  void update(const ScalarVec &s, const ScalarVec &y) override;
+  size_t size() const override { return m_B.size(); }
+  ScalarMatrix todense() const override { return m_B.todense(); }
+  void save_state(Checkpoint &checkpoint) const override {
+    checkpoint.put("trust_bfgs_hessian", m_B.todense());
+  }
+  void load_state(const Checkpoint &checkpoint) override;
+
+private:
+  linalg::SymmetricMatrix m_B;
+  ScalarVec m_bs; // B s
+};
+
+// Dense SR1 [NW 6.24], which may become indefinite; the trust region is
+// what keeps its steps bounded [NW 6.2]
+class DenseSR1Model : public HessianModel {
+public:
+  explicit DenseSR1Model(
+      ScalarType skip_tol = 1e-8,
+      linalg::SymmetricStorage storage = linalg::SymmetricStorage::full)
+      : m_B(0, storage), m_skip_tol(skip_tol) {}
+
+  void reset(size_t ndim) override;
+  void multiply(const ScalarVec &v, ScalarVec &out) const override {
+    m_B.symv(1.0, v, out);
+  }
+  void update(const ScalarVec &s, const ScalarVec &y) override;
+  size_t size() const override { return m_B.size(); }
+  ScalarMatrix todense() const override { return m_B.todense(); }
+  void save_state(Checkpoint &checkpoint) const override {
+    checkpoint.put("trust_sr1_hessian", m_B.todense());
+  }
+  void load_state(const Checkpoint &checkpoint) override;
+
+private:
+  linalg::SymmetricMatrix m_B;
+  ScalarType m_skip_tol;
+  ScalarVec m_r; // y - B s
+};
+
+// Limited memory SR1 in compact form, O(mn) per product
+class CompactSR1Model : public HessianModel {
+public:
+  explicit CompactSR1Model(size_t mem_list = 5, ScalarType skip_tol = 1e-8)
+      : m_corrections(mem_list), m_skip_tol(skip_tol) {}
+
+  void reset(size_t ndim) override {
+    m_sr1 = qn::CompactSR1(m_corrections, ndim, m_skip_tol);
+  }
+  void multiply(const ScalarVec &v, ScalarVec &out) const override;
+  void update(const ScalarVec &s, const ScalarVec &y) override {
+    m_sr1.push(s, y);
+  }
+  size_t size() const override { return m_sr1.ndim(); }
+  const qn::CompactSR1 &compact() const { return m_sr1; }
+  void save_state(Checkpoint &checkpoint) const override;
+  void load_state(const Checkpoint &checkpoint) override;
+
+private:
+  size_t m_corrections;
+  ScalarType m_skip_tol;
+  qn::CompactSR1 m_sr1;
+};
+
+// The true Hessian through Hessian-vector products of the objective, or a
+// gradient difference around the iterate when it gives none, one gradient
+// per product
+class HessianVectorModel : public HessianModel {
+public:
+  void reset(size_t ndim) override {
+    m_ndim = ndim;
+    m_difference.reset();
+  }
+  void at(const FObjFunc &func, const ScalarVec &x,
+          const ScalarVec &gradient) override;
+  void multiply(const ScalarVec &v, ScalarVec &out) const override;
+  size_t size() const override { return m_ndim; }
+
+private:
+  size_t m_ndim{0};
+  const eval::HessianVectorProduct *m_products{nullptr};
+  // Rebuilt at each iterate, seeded with the gradient already known there
+  std::optional<eval::GradientDifferenceHVP> m_difference;
+  FuncVec m_x;
+};
+
+} // namespace trust
+} // namespace optimize
+} // namespace xts
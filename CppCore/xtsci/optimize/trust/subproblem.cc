@@ -0,0 +1,235 @@
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtsci/optimize/linalg/kernels.hpp"
+#include "xtsci/optimize/trust/subproblem.hpp"
+
+namespace xts::optimize::trust {
+
+namespace {
+// tau >= 0 with |p + tau d| = radius, for |p| <= radius
+ScalarType to_boundary(const ScalarVec &p, const ScalarVec &d,
+                       ScalarType radius) {
+  auto [dd, dp] = linalg::multi_dot(d, d, p);
+  const ScalarType pp = linalg::dot(p, p);
+  const ScalarType gap = std::min(pp - radius * radius, ScalarType{0});
+  const ScalarType root = std::sqrt(dp * dp - dd * gap);
+  // The roots have opposite signs, this form avoids the cancellation
+  return dp > 0.0 ? -gap / (dp + root) : (root - dp) / dd;
+}
+
+void resize(ScalarVec &vec, size_t ndim) {
+  if (vec.size() != ndim) {
+    vec = xt::zeros<ScalarType>({ndim});
+  }
+}
+
+// m(0) - m(p) on the dense model
+ScalarType decrease(const ScalarMatrix &hess, const ScalarVec &gradient,
+                    const ScalarVec &step) {
+  const ScalarVec product = xt::linalg::dot(hess, step);
+  return -(linalg::dot(gradient, step) + 0.5 * linalg::dot(step, product));
+}
+} // namespace
+
+SubproblemResult SteihaugCG::solve(const HessianModel &model,
+                                   const ScalarVec &gradient,
+                                   ScalarType radius, ScalarVec &step) {
+  const size_t ndim = gradient.size();
+  resize(m_residual, ndim);
+  resize(m_direction, ndim);
+  resize(m_product, ndim);
+  // r = g + B p throughout, so m(p) = (g.p + r.p) / 2 comes for free
+  auto finish = [&](bool boundary) {
+    auto [gp, rp] = linalg::multi_dot(step, gradient, m_residual);
+    return SubproblemResult{-0.5 * (gp + rp), boundary};
+  };
+  step.fill(0.0);
+  linalg::copy(gradient, m_residual);
+  linalg::axpby(-1.0, gradient, 0.0, m_direction);
+  const ScalarType gnorm = linalg::nrm2(gradient);
+  const ScalarType tol = std::min(ScalarType{0.5}, std::sqrt(gnorm)) * gnorm;
+  const size_t max_iterations =
+      m_max_iterations > 0 ? m_max_iterations : ndim;
+  ScalarType rr = gnorm * gnorm;
+  m_iterations = 0;
+  if (!(gnorm > 0.0)) {
+    return finish(false);
+  }
+  while (m_iterations < max_iterations) {
+    m_iterations++;
+    model.multiply(m_direction, m_product);
+    const ScalarType curvature = linalg::dot(m_direction, m_product);
+    if (!(curvature > 0.0)) {
+      // Negative curvature, the model decreases all the way to the boundary
+      const ScalarType tau = to_boundary(step, m_direction, radius);
+      linalg::axpy(tau, m_direction, step);
+      linalg::axpy(tau, m_product, m_residual);
+      return finish(true);
+    }
+    const ScalarType alpha = rr / curvature;
+    linalg::axpy(alpha, m_direction, step);
+    if (linalg::nrm2(step) >= radius) {
+      linalg::axpy(-alpha, m_direction, step);
+      const ScalarType tau = to_boundary(step, m_direction, radius);
+      linalg::axpy(tau, m_direction, step);
+      linalg::axpy(tau, m_product, m_residual);
+      return finish(true);
+    }
+    linalg::axpy(alpha, m_product, m_residual);
+    const ScalarType rr_next = linalg::dot(m_residual, m_residual);
+    if (std::sqrt(rr_next) < tol) {
+      break;
+    }
+    linalg::axpby(-1.0, m_residual, rr_next / rr, m_direction);
+    rr = rr_next;
+  }
+  return finish(false);
+}
+
+SubproblemResult Dogleg::solve(const HessianModel &model,
+                               const ScalarVec &gradient, ScalarType radius,
+                               ScalarVec &step) {
+  const ScalarMatrix hess = model.todense();
+  const ScalarType gnorm = linalg::nrm2(gradient);
+  if (!(gnorm > 0.0)) {
+    step.fill(0.0);
+    return {0.0, false};
+  }
+  const ScalarVec bg = xt::linalg::dot(hess, gradient);
+  const ScalarType gbg = linalg::dot(gradient, bg);
+  auto [evals, evecs] = xt::linalg::eigh(hess);
+  if (!(evals(0) > 0.0)) {
+    // Cauchy point, on the boundary unless the curvature along g stops it
+    ScalarType tau = 1.0;
+    if (gbg > 0.0) {
+      tau = std::min(ScalarType{1}, gnorm * gnorm * gnorm / (radius * gbg));
+    }
+    linalg::axpby(-tau * radius / gnorm, gradient, 0.0, step);
+    return {decrease(hess, gradient, step), tau == 1.0};
+  }
+  // Newton step -B^-1 g in the eigenbasis
+  ScalarVec newton = xt::linalg::dot(xt::transpose(evecs), gradient);
+  newton /= evals;
+  newton = -xt::linalg::dot(evecs, newton);
+  if (linalg::nrm2(newton) <= radius) {
+    linalg::copy(newton, step);
+    return {decrease(hess, gradient, step), false};
+  }
+  // Minimizer along -g
+  linalg::axpby(-gnorm * gnorm / gbg, gradient, 0.0, step);
+  const ScalarType unorm = linalg::nrm2(step);
+  if (unorm >= radius) {
+    linalg::scal(radius / unorm, step);
+  } else {
+    linalg::axpy(-1.0, step, newton);
+    linalg::axpy(to_boundary(step, newton, radius), newton, step);
+  }
+  return {decrease(hess, gradient, step), true};
+}
+
+SubproblemResult ExactSubproblem::solve(const HessianModel &model,
+                                        const ScalarVec &gradient,
+                                        ScalarType radius, ScalarVec &step) {
+  const ScalarMatrix hess = model.todense();
+  const size_t ndim = gradient.size();
+  auto [evals, evecs] = xt::linalg::eigh(hess);
+  ScalarVec ghat = xt::linalg::dot(xt::transpose(evecs), gradient);
+  const ScalarType eps = std::numeric_limits<ScalarType>::epsilon();
+  const ScalarType scale =
+      std::max(std::abs(evals(0)), std::abs(evals(ndim - 1)));
+  const ScalarType lowest = evals(0);
+  // |p(lambda)| with p(lambda) = -(B + lambda I)^-1 g in the eigenbasis,
+  // skipping the components which are (near) zero over (near) zero
+  auto step_norm = [&](ScalarType lambda) {
+    ScalarType sum = 0.0;
+    for (size_t idx = 0; idx < ndim; ++idx) {
+      const ScalarType shifted = evals(idx) + lambda;
+      if (ghat(idx) != 0.0) {
+        sum += ghat(idx) * ghat(idx) / (shifted * shifted);
+      }
+    }
+    return std::sqrt(sum);
+  };
+  ScalarVec phat = xt::zeros<ScalarType>({ndim});
+  auto fill = [&](ScalarType lambda) {
+    for (size_t idx = 0; idx < ndim; ++idx) {
+      phat(idx) = ghat(idx) == 0.0 ? 0.0 : -ghat(idx) / (evals(idx) + lambda);
+    }
+  };
+  bool boundary = true;
+  if (lowest > 0.0 && step_norm(0.0) <= radius) {
+    fill(0.0);
+    boundary = false;
+  } else {
+    // Components along the lowest eigenvalue with no gradient make the hard
+    // case, where |p(lambda)| may stay inside as lambda -> -lambda_1 [NW 4.3]
+    const ScalarType cluster = lowest + std::sqrt(eps) * scale;
+    const ScalarType gnorm = linalg::nrm2(gradient);
+    ScalarType low = std::max(ScalarType{0}, -lowest);
+    ScalarVec ghat_low = ghat;
+    for (size_t idx = 0; idx < ndim && evals(idx) <= cluster; ++idx) {
+      if (ghat(idx) != 0.0 && std::abs(ghat(idx)) <= std::sqrt(eps) * gnorm) {
+        ghat_low(idx) = 0.0;
+      }
+    }
+    // With those dropped, hard when p(-lambda_1) is still inside, e.g. at a
+    // saddle point where g = 0
+    bool hard = false;
+    if (lowest <= 0.0) {
+      std::swap(ghat, ghat_low);
+      hard = step_norm(low) <= radius;
+      if (!hard) {
+        std::swap(ghat, ghat_low);
+      }
+    }
+    if (hard) {
+      // p(-lambda_1) plus the lowest eigenvector out to the boundary
+      fill(low);
+      ScalarVec unit = xt::zeros<ScalarType>({ndim});
+      unit(0) = 1.0;
+      phat(0) = 0.0;
+      phat(0) = to_boundary(phat, unit, radius);
+    } else {
+      // Newton on 1 / |p(lambda)| - 1 / radius, nearly linear in lambda
+      // [NW Algorithm 4.3], safeguarded by bisection
+      ScalarType high = low + gnorm / radius + scale;
+      ScalarType lambda = low + std::sqrt(eps) * std::max(ScalarType{1}, scale);
+      for (size_t iter = 0; iter < 100; ++iter) {
+        const ScalarType pnorm = step_norm(lambda);
+        if (std::abs(pnorm - radius) <= 1e-10 * radius) {
+          break;
+        }
+        (pnorm > radius ? low : high) = lambda;
+        ScalarType cubes = 0.0;
+        for (size_t idx = 0; idx < ndim; ++idx) {
+          const ScalarType shifted = evals(idx) + lambda;
+          cubes += ghat(idx) * ghat(idx) / (shifted * shifted * shifted);
+        }
+        // d/dlambda (1 / |p|) = sum ghat^2 / shifted^3 / |p|^3
+        const ScalarType slope = cubes / (pnorm * pnorm * pnorm);
+        lambda += (1.0 / radius - 1.0 / pnorm) / slope;
+        if (!(lambda > low && lambda < high)) {
+          lambda = 0.5 * (low + high);
+        }
+      }
+      fill(lambda);
+    }
+  }
+  ScalarType predicted = 0.0;
+  for (size_t idx = 0; idx < ndim; ++idx) {
+    predicted -= phat(idx) * (ghat(idx) + 0.5 * evals(idx) * phat(idx));
+  }
+  linalg::copy(ScalarVec(xt::linalg::dot(evecs, phat)), step);
+  return {predicted, boundary};
+}
+
+} // namespace xts::optimize::trust
@@ -0,0 +1,72 @@
+#pragma once
+// MIT License
+// Copyright 2023--present Rohit Goswami <HaoZeke>
+#include <cstddef>
+
+#include "xtsci/optimize/numerics.hpp"
+#include "xtsci/optimize/trust/model.hpp"
+
+namespace xts {
+namespace optimize {
+namespace trust {
+
+struct SubproblemResult {
+  ScalarType predicted; // m(0) - m(p), the decrease the model promises
+  bool boundary;        // whether p was stopped by the radius
+};
+
+// Approximately minimizes g.p + p.B p / 2 over |p| <= radius, writing p
+// into step, which has the size of g
+//
+// References:
+// [NW] Nocedal, J., & Wright, S. J. (2006). Numerical optimization (2nd ed).
+// Springer. Chapters 4 and 7
+class SubproblemSolver {
+public:
+  virtual ~SubproblemSolver() = default;
+  virtual SubproblemResult solve(const HessianModel &model,
+                                 const ScalarVec &gradient, ScalarType radius,
+                                 ScalarVec &step) = 0;
+};
+
+// Truncated CG [NW Algorithm 7.2], stopping at the boundary, on negative
+// curvature, or once |r| <= min(0.5, sqrt|g|) |g|. Uses only products, so it
+// suits limited memory and Hessian-vector models.
+class SteihaugCG : public SubproblemSolver {
+public:
+  // 0 allows n iterations
+  explicit SteihaugCG(size_t max_iterations = 0)
+      : m_max_iterations(max_iterations) {}
+
+  SubproblemResult solve(const HessianModel &model, const ScalarVec &gradient,
+                         ScalarType radius, ScalarVec &step) override;
+  // CG iterations, i.e. products, of the last solve
+  size_t iterations() const { return m_iterations; }
+
+private:
+  size_t m_max_iterations;
+  size_t m_iterations{0};
+  ScalarVec m_residual, m_direction, m_product;
+};
+
+// Dogleg path between the Cauchy point and the Newton step [NW 4.1], on the
+// dense model. When B is not positive definite the Cauchy point [NW 4.12]
+// is taken.
+class Dogleg : public SubproblemSolver {
+public:
+  SubproblemResult solve(const HessianModel &model, const ScalarVec &gradient,
+                         ScalarType radius, ScalarVec &step) override;
+};
+
+// The global minimizer of the model in the ball [NW 4.3], from an
+// eigendecomposition of the dense B, including the hard case. O(n^3), for
+// small n.
+class ExactSubproblem : public SubproblemSolver {
+public:
+  SubproblemResult solve(const HessianModel &model, const ScalarVec &gradient,
+                         ScalarType radius, ScalarVec &step) override;
+};
+
+} // namespace trust
+} // namespace optimize
+} // namespace xts